@@ -52,9 +52,15 @@ public:
      */
     void zoom(const float zoom_amount);
 
+    // Move the point the camera rotates around, keeping the orientation and the distance to it
+    void set_center(const QVector3D& center);
+
     // Get the eye direction of the camera in world space
     QVector3D dir() const;
 
+    // Distance from the eye to the center, 0 for the orthographic projection
+    float distance() const {return perspective == m_projection_type ? std::abs(m_translation_matrix(2,3)) : 0.F;}
+
     static constexpr float zoom_coefficient_qt = 0.001f;
     void update();
 
@@ -62,7 +68,6 @@ public:
     QMatrix4x4 get_projection_matrix() const;
     QMatrix4x4 get_projection_view_matrix() const;
 
-    void set_standard_uniforms(QOpenGLShaderProgram* shader, const QMatrix4x4 &model_matrix) const;
     void set_window_size(const std::size_t width, const std::size_t height);
     QVector2D window_size() const;
 
@@ -154,6 +159,15 @@ Camera::zoom(const float zoom_amount)
     update();
 }
 
+inline void
+Camera::set_center(const QVector3D& center)
+{
+    m_center = center;
+    m_center_translation.setToIdentity();
+    m_center_translation.translate(-center);
+    update();
+}
+
 inline QVector3D
 Camera::dir() const
 {
@@ -219,23 +233,6 @@ Camera::get_projection_view_matrix() const
     return m_proj_matrix * m_view_matrix;
 }
 
-inline void
-Camera::set_standard_uniforms(QOpenGLShaderProgram* shader, const QMatrix4x4& model_matrix) const
-{
-    if (!shader)
-        return;
-
-    QMatrix4x4 model_view_matrix = m_view_matrix * model_matrix;
-    QMatrix4x4 mvp = m_proj_matrix * model_view_matrix;
-
-    shader->bind();
-    shader->setUniformValue("model_matrix", model_matrix);
-    shader->setUniformValue("model_view_matrix", model_view_matrix);
-    shader->setUniformValue("projection_matrix", m_proj_matrix);
-    shader->setUniformValue("mvp", mvp);
-    shader->release();
-}
-
 inline void
 Camera::set_window_size(const std::size_t width, const std::size_t height)
 {
@@ -0,0 +1,284 @@
+#ifndef DEPTHIMAGE_H
+#define DEPTHIMAGE_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <limits>
+#include <filesystem>
+#include <algorithm>
+
+#include <QImage>
+#include <QString>
+
+#include <opengl_helper.hpp>
+#include <plyloader.h>
+#include <parallel.hpp>
+#include <normals.h>
+
+namespace graphics {
+
+/*!
+ * \brief Pinhole intrinsics of a depth camera
+ * depth_scale converts the 16-bit depth values to meters (0.001 for millimeters), depth values
+ * beyond max_depth (meters, 0 for no limit) are invalid like the zero ones.
+ */
+struct CameraIntrinsics
+{
+    float fx {0.F};
+    float fy {0.F};
+    float cx {0.F};
+    float cy {0.F};
+    float depth_scale {0.001F};
+    float max_depth {0.F};
+
+    bool is_valid() const { return fx > 0.F && fy > 0.F && depth_scale > 0.F; }
+};
+
+/*!
+ * \brief parse_intrinsics
+ * Accepts "fx fy cx cy [depth_scale [max_depth]]" as plain numbers, or the same values by name
+ * ("fx: 525", "depth_scale=0.001", ...). Lines starting with # are comments.
+ */
+inline bool
+parse_intrinsics(const std::string& text, CameraIntrinsics& intrinsics)
+{
+    CameraIntrinsics k = intrinsics;
+    float* const positional[] = {&k.fx, &k.fy, &k.cx, &k.cy, &k.depth_scale, &k.max_depth};
+    const char* const names[] = {"fx", "fy", "cx", "cy", "depth_scale", "max_depth"};
+    std::size_t next_positional = 0;
+    std::size_t values_count = 0;
+
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.empty() || '#' == line.front())
+            continue;
+        std::replace_if(line.begin(), line.end(), [](const char c) { return '=' == c || ':' == c || ',' == c; }, ' ');
+
+        std::istringstream tokens(line);
+        std::string token;
+        while (tokens >> token) {
+            float* value = nullptr;
+            for (std::size_t i=0; i<std::size(names); i++) {
+                if (token == names[i] && (tokens >> token))
+                    value = positional[i];
+            }
+            if (nullptr == value) {
+                if (next_positional >= std::size(positional))
+                    return false;
+                value = positional[next_positional++];
+            }
+
+            try {
+                *value = std::stof(token);
+            } catch (const std::exception&) {
+                return false;
+            }
+            values_count++;
+        }
+    }
+
+    if (values_count < 4 || !k.is_valid())
+        return false;
+
+    intrinsics = k;
+    return true;
+}
+
+inline bool
+read_intrinsics(const std::string& file_name, CameraIntrinsics& intrinsics)
+{
+    std::ifstream file(file_name);
+    if (!file.is_open())
+        return false;
+
+    std::stringstream text;
+    text << file.rdbuf();
+    if (!parse_intrinsics(text.str(), intrinsics)) {
+        std::cerr << "read_intrinsics: expected fx fy cx cy [depth_scale [max_depth]] in " << file_name << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/*!
+ * \brief find_intrinsics_file
+ * \param path depth image or directory of a depth sequence
+ * \return intrinsics.txt of the directory or of its parent, empty if there is none
+ */
+inline std::string
+find_intrinsics_file(const std::string& path)
+{
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    fs::path directory = fs::is_directory(path, ec) ? fs::path(path) : fs::path(path).parent_path();
+
+    for (int level=0; level<2 && !directory.empty(); level++) {
+        const fs::path candidate = directory / "intrinsics.txt";
+        if (fs::is_regular_file(candidate, ec))
+            return candidate.string();
+        directory = directory.parent_path();
+    }
+    return {};
+}
+
+/*!
+ * \brief find_color_image
+ * Colour image of a depth image: the same file name in a color/ or rgb/ directory next to the
+ * depth directory (dataset/depth/0001.png -> dataset/color/0001.jpg), or "depth" replaced by
+ * "color" in the file name.
+ * \return empty if there is none
+ */
+inline std::string
+find_color_image(const std::string& depth_file)
+{
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    const fs::path depth_path(depth_file);
+    const std::string stem = depth_path.stem().string();
+    const char* const extensions[] = {".png", ".jpg", ".jpeg"};
+
+    for (const char* directory : {"color", "rgb", "colour"}) {
+        for (const char* extension : extensions) {
+            const fs::path candidate = depth_path.parent_path().parent_path() / directory / (stem + extension);
+            if (fs::is_regular_file(candidate, ec))
+                return candidate.string();
+        }
+    }
+
+    const std::size_t at = stem.find("depth");
+    if (std::string::npos != at) {
+        for (const char* name : {"color", "rgb"}) {
+            std::string color_stem = stem;
+            color_stem.replace(at, 5, name);
+            for (const char* extension : extensions) {
+                const fs::path candidate = depth_path.parent_path() / (color_stem + extension);
+                if (fs::is_regular_file(candidate, ec))
+                    return candidate.string();
+            }
+        }
+    }
+    return {};
+}
+
+/*!
+ * \brief back_project_depth
+ * Back-projects a 16-bit depth image into an organized cloud of width x height points, rows
+ * split over the hardware threads. Ray directions come from a per-column table and one division
+ * per row, so the inner loop is a branch-free multiply per pixel the compiler can vectorize.
+ * Points are in the viewer frame (x right, y up, the camera looking down -z), invalid depths
+ * give NaN points (see is_valid_point(...)).
+ * \param depth first row, rows depth_stride bytes apart
+ * \param colors_rgba8 first row of an RGBA8 colour image, rows color_stride bytes apart, nullptr for none.
+ * A colour image of another size is sampled at the nearest pixel.
+ */
+inline VertexData
+back_project_depth(const std::uint16_t* depth, const std::size_t width, const std::size_t height, const std::size_t depth_stride,
+                   const std::uint8_t* colors_rgba8, const std::size_t color_width, const std::size_t color_height, const std::size_t color_stride,
+                   const CameraIntrinsics& intrinsics)
+{
+    VertexData vertex_data;
+    if (nullptr == depth || 0 == width || 0 == height || !intrinsics.is_valid())
+        return vertex_data;
+
+    const std::size_t count = width * height;
+    const bool has_colors = nullptr != colors_rgba8 && color_width > 0 && color_height > 0;
+    vertex_data.positions.resize(count);
+    vertex_data.colors.resize(has_colors ? count : 0);
+    vertex_data.width = width;
+    vertex_data.height = height;
+    vertex_data.color_type = tinyply::Type::UINT8;
+    vertex_data.has_alpha = false;
+
+    std::vector<float> ray_x(width);
+    std::vector<std::size_t> color_column(width);
+    for (std::size_t u=0; u<width; u++) {
+        ray_x[u] = (static_cast<float>(u) - intrinsics.cx) / intrinsics.fx;
+        color_column[u] = u * color_width / width * 4;
+    }
+
+    const float scale = intrinsics.depth_scale;
+    const float max_depth = intrinsics.max_depth > 0.F ? intrinsics.max_depth : std::numeric_limits<float>::max();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+
+    parallel_for(0, height, std::max<std::size_t>(1, (1 << 14) / width), [&](const std::size_t row_begin, const std::size_t row_end) {
+        for (std::size_t v=row_begin; v<row_end; v++) {
+            const std::uint16_t* d = reinterpret_cast<const std::uint16_t*>(reinterpret_cast<const std::uint8_t*>(depth) + v * depth_stride);
+            const float ray_y = (static_cast<float>(v) - intrinsics.cy) / intrinsics.fy;
+            QVector3D* p = vertex_data.positions.data() + v * width;
+
+            for (std::size_t u=0; u<width; u++) {
+                const float z = static_cast<float>(d[u]) * scale;
+                const bool valid = d[u] != 0 && z <= max_depth;
+                p[u] = valid ? QVector3D(z * ray_x[u], -z * ray_y, -z) : QVector3D(nan, nan, nan);
+            }
+
+            if (has_colors) {
+                const std::uint8_t* c = colors_rgba8 + (v * color_height / height) * color_stride;
+                QVector4D* color = vertex_data.colors.data() + v * width;
+                for (std::size_t u=0; u<width; u++) {
+                    const std::uint8_t* rgba = c + color_column[u];
+                    color[u] = QVector4D(rgba[0] / 255.F, rgba[1] / 255.F, rgba[2] / 255.F, 1.F);
+                }
+            }
+        }
+    });
+
+    return vertex_data;
+}
+
+/*!
+ * \brief read_depth_image
+ * \param depth_file 16-bit grayscale PNG
+ * \param color_file colour image, empty for none (the points are coloured by depth)
+ * \param with_normals fills the normals from the pixel grid, see compute_organized_normals(...)
+ */
+inline VertexData
+read_depth_image(const std::string& depth_file, const std::string& color_file, const CameraIntrinsics& intrinsics, const bool with_normals = true)
+{
+    manual_timer timer;
+    timer.start();
+
+    const QImage depth(QString::fromStdString(depth_file));
+    if (depth.isNull() || QImage::Format_Grayscale16 != depth.format()) {
+        std::cerr << "read_depth_image: " << depth_file << " is not a 16-bit grayscale image" << std::endl;
+        return {};
+    }
+
+    QImage color;
+    if (!color_file.empty()) {
+        color = QImage(QString::fromStdString(color_file)).convertToFormat(QImage::Format_RGBA8888);
+        if (color.isNull())
+            std::cerr << "read_depth_image: could not read " << color_file << ", coloring by depth" << std::endl;
+    }
+
+    timer.stop();
+    const double decode_time = timer.get();
+    timer.start();
+
+    VertexData vertex_data = back_project_depth(reinterpret_cast<const std::uint16_t*>(depth.constBits()),
+                                                static_cast<std::size_t>(depth.width()), static_cast<std::size_t>(depth.height()),
+                                                static_cast<std::size_t>(depth.bytesPerLine()),
+                                                color.isNull() ? nullptr : color.constBits(),
+                                                static_cast<std::size_t>(color.width()), static_cast<std::size_t>(color.height()),
+                                                static_cast<std::size_t>(color.bytesPerLine()), intrinsics);
+    timer.stop();
+    const double projection_time = timer.get();
+    timer.start();
+
+    if (with_normals)
+        compute_organized_normals(vertex_data);
+    timer.stop();
+
+    std::cout << "Depth image " << depth_file << ": " << vertex_data.width << "x" << vertex_data.height
+              << (color.isNull() ? "" : " with colour") << ", decoded in " << decode_time << " ms, back-projected in " << projection_time << " ms"
+              << (with_normals ? ", normals in " + std::to_string(timer.get()) + " ms" : std::string()) << std::endl;
+    return vertex_data;
+}
+
+}
+
+#endif // DEPTHIMAGE_H
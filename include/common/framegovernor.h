@@ -0,0 +1,87 @@
+#ifndef FRAMEGOVERNOR_H
+#define FRAMEGOVERNOR_H
+
+#include <cmath>
+#include <algorithm>
+
+namespace graphics {
+
+/*!
+ * \brief The FrameGovernor class
+ * Holds a target frame time by trading quality for speed. A single quality level in [0, 1] is
+ * driven by the measured frame time (GPU time when available), in the log of target / time so that
+ * being twice too slow or twice too fast weighs the same. Within a deadband around the target the
+ * level is left alone, and it drops faster than it recovers, so the levers do not pump.
+ *
+ * The level is mapped onto the levers from the cheapest loss to the most visible one:
+ *   1.0 - 0.9  full quality
+ *   below 0.9  multisampling off
+ *   0.9 - 0.6  render scale 1 to 0.5
+ *   0.6 - 0.2  point budget 1 to m_min_point_budget (geometric), points enlarged to cover the gaps
+ *   0.2 - 0.0  render scale 0.5 to m_min_scale
+ */
+class FrameGovernor
+{
+public:
+    struct Levers
+    {
+        bool msaa {true};
+        float render_scale {1.F};     // along both axes
+        float point_budget {1.F};     // fraction of the points drawn
+        float point_size_scale {1.F}; // applied to the point size
+    };
+
+    float m_target_frame_time {1000.F / 60.F}; // ms
+    float m_min_point_budget {0.1F};
+    float m_min_scale {0.25F};
+    float m_max_point_size_scale {2.5F};
+
+    float quality() const { return m_quality; }
+    double frame_time() const { return m_frame_time; } // ms, smoothed
+    const Levers& levers() const { return m_levers; }
+
+    void reset()
+    {
+        m_quality = 1.F;
+        m_frame_time = 0.;
+        m_levers = levers_for(m_quality);
+    }
+
+    // frame_time of the last frame measured, rendered with levers()
+    const Levers& update(const double frame_time)
+    {
+        if (frame_time <= 0.)
+            return m_levers;
+
+        m_frame_time = m_frame_time <= 0. ? frame_time : 0.8 * m_frame_time + 0.2 * frame_time;
+        const float ratio = m_target_frame_time / static_cast<float>(m_frame_time);
+        if (ratio < 0.9F || ratio > 1.25F) {
+            const float gain = ratio < 1.F ? 0.15F : 0.08F;
+            m_quality = std::clamp(m_quality + gain * std::log(ratio), 0.F, 1.F);
+        }
+        m_levers = levers_for(m_quality);
+        return m_levers;
+    }
+
+    Levers levers_for(const float quality) const
+    {
+        auto ramp = [quality](const float low, const float high) { return std::clamp((quality - low) / (high - low), 0.F, 1.F); };
+
+        Levers levers;
+        levers.msaa = quality > 0.9F;
+        levers.render_scale = quality >= 0.2F ? 0.5F + 0.5F * ramp(0.6F, 0.9F)
+                                              : m_min_scale + (0.5F - m_min_scale) * ramp(0.F, 0.2F);
+        levers.point_budget = std::pow(m_min_point_budget, 1.F - ramp(0.2F, 0.6F));
+        levers.point_size_scale = std::min(m_max_point_size_scale, 1.F / std::sqrt(levers.point_budget));
+        return levers;
+    }
+
+private:
+    float m_quality {1.F};
+    double m_frame_time {0.};
+    Levers m_levers;
+};
+
+}
+
+#endif // FRAMEGOVERNOR_H
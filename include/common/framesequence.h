@@ -0,0 +1,268 @@
+#ifndef FRAMESEQUENCE_H
+#define FRAMESEQUENCE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <filesystem>
+#include <algorithm>
+
+#include <opengl_helper.hpp>
+#include <plyloader.h>
+#include <parallel.hpp>
+
+namespace graphics {
+
+/*!
+ * \brief The FrameSequence class
+ * Recording stored as one file per frame (frame_00001.ply, ...), ordered by file name.
+ * Worker threads decode the frames ahead of the cursor into a bounded ring of ready frames,
+ * the consumer takes them without ever waiting for a decode.
+ */
+class FrameSequence
+{
+public:
+    using Decoder = std::function<VertexData(const std::string&)>;
+
+    explicit FrameSequence(const std::size_t ring_size = 8, const std::size_t workers_count = 0);
+    ~FrameSequence();
+
+    FrameSequence(const FrameSequence&) = delete;
+    FrameSequence& operator=(const FrameSequence&) = delete;
+
+    void set_decoder(Decoder decoder); // before open(...), read_ply(...) by default
+    bool open(const std::string& directory, const std::string& extension = ".ply");
+
+    void seek(const std::size_t index);
+    std::unique_ptr<VertexData> take(const std::size_t index);
+
+    std::size_t size() const { return m_files.size(); }
+    std::size_t ring_size() const { return m_ring_size; }
+    std::size_t ready_count() const;
+    const std::string& frame_name(const std::size_t index) const { return m_files[index]; }
+
+private:
+    void start_workers();
+    void stop_workers();
+    void worker_loop();
+    bool next_job(std::size_t& index) const;
+    bool in_window(const std::size_t index) const;
+    void evict();
+
+    std::vector<std::string> m_files;
+    Decoder m_decoder;
+    std::size_t m_ring_size {8};
+    std::size_t m_workers_count {1};
+
+    std::size_t m_cursor {0}; // first frame of the prefetch window
+    std::map<std::size_t, std::unique_ptr<VertexData>> m_ready;
+    std::set<std::size_t> m_in_flight;
+    bool m_stop {false};
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::vector<std::thread> m_workers;
+};
+
+inline
+FrameSequence::FrameSequence(const std::size_t ring_size, const std::size_t workers_count)
+    : m_decoder([](const std::string& file_name) { return read_ply(file_name); })
+    , m_ring_size(std::max<std::size_t>(1, ring_size))
+    , m_workers_count(workers_count > 0 ? workers_count : std::clamp<std::size_t>(hardware_threads() / 2, 1, 4))
+{
+}
+
+inline
+FrameSequence::~FrameSequence()
+{
+    stop_workers();
+}
+
+inline void
+FrameSequence::set_decoder(Decoder decoder)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_decoder = std::move(decoder);
+}
+
+inline bool
+FrameSequence::open(const std::string& directory, const std::string& extension)
+{
+    namespace fs = std::filesystem;
+    stop_workers();
+
+    m_files.clear();
+    m_ready.clear();
+    m_in_flight.clear();
+    m_cursor = 0;
+
+    std::error_code ec;
+    for (const auto& item : fs::directory_iterator(directory, ec)) {
+        std::string item_extension = item.path().extension().string();
+        std::transform(item_extension.begin(), item_extension.end(), item_extension.begin(), ::tolower);
+        if (item.is_regular_file(ec) && item_extension == extension)
+            m_files.emplace_back(item.path().string());
+    }
+    std::sort(m_files.begin(), m_files.end()); // frame numbers are expected to be zero padded
+
+    std::cout << "Frame sequence " << directory << ": " << m_files.size() << " frames, "
+              << m_workers_count << " decoding threads" << std::endl;
+
+    if (m_files.empty())
+        return false;
+
+    start_workers();
+    return true;
+}
+
+inline bool
+FrameSequence::in_window(const std::size_t index) const
+{
+    const std::size_t count = m_files.size();
+    return (index + count - m_cursor) % count < std::min(m_ring_size, count);
+}
+
+inline void
+FrameSequence::evict()
+{
+    for (auto it = m_ready.begin(); it != m_ready.end();) {
+        if (in_window(it->first))
+            ++it;
+        else
+            it = m_ready.erase(it);
+    }
+}
+
+/*!
+ * \brief FrameSequence::seek
+ * Moves the prefetch window, frames outside of it are dropped and decoding restarts at index.
+ */
+inline void
+FrameSequence::seek(const std::size_t index)
+{
+    if (m_files.empty())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cursor = index % m_files.size();
+        evict();
+    }
+    m_condition.notify_all();
+}
+
+/*!
+ * \brief FrameSequence::take
+ * \return the decoded frame and moves the window behind it, or nullptr if it is not decoded yet
+ * (the window is moved to the frame if it was outside of it)
+ */
+inline std::unique_ptr<VertexData>
+FrameSequence::take(const std::size_t index)
+{
+    if (m_files.empty())
+        return nullptr;
+
+    std::unique_ptr<VertexData> frame;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_ready.find(index);
+        if (it != m_ready.end()) {
+            frame = std::move(it->second);
+            m_ready.erase(it);
+            m_cursor = (index + 1) % m_files.size();
+            evict();
+        } else if (!in_window(index)) {
+            m_cursor = index % m_files.size();
+            evict();
+        } else {
+            return nullptr;
+        }
+    }
+    m_condition.notify_all();
+    return frame;
+}
+
+inline std::size_t
+FrameSequence::ready_count() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_ready.size();
+}
+
+// Nearest frame of the window that is neither decoded nor being decoded, called with the mutex locked
+inline bool
+FrameSequence::next_job(std::size_t& index) const
+{
+    const std::size_t count = m_files.size();
+    const std::size_t window = std::min(m_ring_size, count);
+    for (std::size_t k=0; k<window; k++) {
+        const std::size_t i = (m_cursor + k) % count;
+        if (m_ready.find(i) == m_ready.end() && m_in_flight.find(i) == m_in_flight.end()) {
+            index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline void
+FrameSequence::worker_loop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        std::size_t index = 0;
+        m_condition.wait(lock, [this, &index]() { return m_stop || next_job(index); });
+        if (m_stop)
+            return;
+
+        m_in_flight.insert(index);
+        const Decoder decoder = m_decoder;
+        const std::string file_name = m_files[index];
+        lock.unlock();
+
+        std::unique_ptr<VertexData> frame = std::make_unique<VertexData>();
+        try {
+            *frame = decoder(file_name);
+        } catch (const std::exception& e) {
+            std::cerr << "FrameSequence: failed to decode " << file_name << ": " << e.what() << std::endl;
+        }
+
+        lock.lock();
+        m_in_flight.erase(index);
+        if (in_window(index)) // the window may have moved on while decoding
+            m_ready[index] = std::move(frame);
+    }
+}
+
+inline void
+FrameSequence::start_workers()
+{
+    m_stop = false;
+    for (std::size_t t=0; t<m_workers_count; t++)
+        m_workers.emplace_back(&FrameSequence::worker_loop, this);
+}
+
+inline void
+FrameSequence::stop_workers()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+
+    for (auto& t : m_workers)
+        t.join();
+    m_workers.clear();
+}
+
+}
+
+#endif // FRAMESEQUENCE_H
@@ -0,0 +1,319 @@
+#ifndef KDTREE_H
+#define KDTREE_H
+
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <limits>
+#include <algorithm>
+#include <functional>
+
+#include <QVector3D>
+
+#include <opengl_helper.hpp>
+#include <plyloader.h>
+#include <parallel.hpp>
+
+namespace graphics {
+
+/*!
+ * \brief The KdTree class
+ * Static k-d tree over point positions, stored implicitly in flat arrays: the points are
+ * reordered so that every subtree is a contiguous range whose median is the split point, no
+ * node is allocated. The split axis is the longest extent of the range, ranges of up to
+ * leaf_size points are scanned linearly. Invalid points (NaN) are left out.
+ *
+ * Indices returned by the queries refer to the positions given to build(...). Queries are
+ * const and keep no state, any number of threads can run them concurrently.
+ */
+class KdTree
+{
+public:
+    static constexpr std::uint32_t invalid_index = std::numeric_limits<std::uint32_t>::max();
+    static constexpr std::size_t leaf_size = 16;
+
+    bool build(const std::vector<QVector3D>& positions, const std::atomic<bool>* cancel = nullptr);
+    void clear();
+
+    std::size_t size() const { return m_points.size(); }
+    bool empty() const { return m_points.empty(); }
+    double build_time() const { return m_build_time; } // ms
+    std::size_t memory_bytes() const;
+
+    // Nearest point, false if the tree is empty
+    bool nearest(const QVector3D& query, std::uint32_t& index, float& squared_distance) const;
+
+    // Up to k nearest points, closest first
+    void knn(const QVector3D& query, const std::size_t k, std::vector<std::uint32_t>& indices, std::vector<float>& squared_distances) const;
+
+    // Every point closer than radius, in no particular order
+    void radius_search(const QVector3D& query, const float radius, std::vector<std::uint32_t>& indices, std::vector<float>& squared_distances) const;
+
+    // Batched queries split over the hardware threads. knn results are stored k per query,
+    // padded with invalid_index when the tree holds less than k points.
+    void knn_batch(const std::vector<QVector3D>& queries, const std::size_t k, std::vector<std::uint32_t>& indices, std::vector<float>& squared_distances) const;
+    void radius_batch(const std::vector<QVector3D>& queries, const float radius, std::vector<std::vector<std::uint32_t>>& indices) const;
+
+private:
+    struct Neighbours; // bounded max-heap of the k best candidates
+    struct Entry
+    {
+        QVector3D point;
+        std::uint32_t index;
+    };
+
+    void build_range(std::vector<Entry>& entries, const std::size_t begin, const std::size_t end, const std::size_t spawn_depth, const std::atomic<bool>* cancel);
+    void knn_range(const std::size_t begin, const std::size_t end, const QVector3D& query, Neighbours& best) const;
+    void radius_range(const std::size_t begin, const std::size_t end, const QVector3D& query, const float squared_radius,
+                      std::vector<std::uint32_t>& indices, std::vector<float>& squared_distances) const;
+
+    std::vector<QVector3D> m_points;       // reordered positions
+    std::vector<std::uint32_t> m_indices;  // index of every reordered point in the positions given to build(...)
+    std::vector<std::uint8_t> m_split_axis; // split axis of the range whose median is at this position
+    double m_build_time {0.};
+};
+
+struct KdTree::Neighbours
+{
+    std::size_t k {0};
+    std::vector<std::pair<float, std::uint32_t>> heap; // squared distance, reordered index
+
+    float worst() const { return heap.size() < k ? std::numeric_limits<float>::max() : heap.front().first; }
+    void add(const float squared_distance, const std::uint32_t i)
+    {
+        if (heap.size() < k) {
+            heap.emplace_back(squared_distance, i);
+            std::push_heap(heap.begin(), heap.end());
+        } else if (squared_distance < heap.front().first) {
+            std::pop_heap(heap.begin(), heap.end());
+            heap.back() = {squared_distance, i};
+            std::push_heap(heap.begin(), heap.end());
+        }
+    }
+};
+
+/*!
+ * \brief KdTree::build
+ * The two halves of the upper levels are split on their own threads.
+ * \param cancel checked while building, the tree is left empty when it is set
+ * \return false if cancelled
+ */
+inline bool
+KdTree::build(const std::vector<QVector3D>& positions, const std::atomic<bool>* cancel)
+{
+    manual_timer timer;
+    timer.start();
+    clear();
+
+    std::vector<Entry> entries;
+    entries.reserve(positions.size());
+    for (std::size_t i=0; i<positions.size(); i++) {
+        if (is_valid_point(positions[i]))
+            entries.push_back({positions[i], static_cast<std::uint32_t>(i)});
+    }
+    m_split_axis.assign(entries.size(), 0);
+
+    std::size_t spawn_depth = 0;
+    while ((std::size_t(1) << spawn_depth) < hardware_threads())
+        spawn_depth++;
+    build_range(entries, 0, entries.size(), spawn_depth, cancel);
+
+    if (cancel && *cancel) {
+        clear();
+        return false;
+    }
+
+    // Split in two arrays, the traversal reads only the points
+    m_points.resize(entries.size());
+    m_indices.resize(entries.size());
+    for (std::size_t i=0; i<entries.size(); i++) {
+        m_points[i] = entries[i].point;
+        m_indices[i] = entries[i].index;
+    }
+
+    timer.stop();
+    m_build_time = timer.get();
+    return true;
+}
+
+inline void
+KdTree::clear()
+{
+    m_points.clear();
+    m_indices.clear();
+    m_split_axis.clear();
+    m_build_time = 0.;
+}
+
+inline std::size_t
+KdTree::memory_bytes() const
+{
+    return m_points.capacity() * sizeof(QVector3D) + m_indices.capacity() * sizeof(std::uint32_t) + m_split_axis.capacity();
+}
+
+inline void
+KdTree::build_range(std::vector<Entry>& entries, const std::size_t begin, const std::size_t end, const std::size_t spawn_depth, const std::atomic<bool>* cancel)
+{
+    if (end - begin <= leaf_size || (cancel && *cancel))
+        return;
+
+    QVector3D min = entries[begin].point;
+    QVector3D max = entries[begin].point;
+    for (std::size_t i=begin+1; i<end; i++) {
+        for (int a=0; a<3; a++) {
+            min[a] = std::min(min[a], entries[i].point[a]);
+            max[a] = std::max(max[a], entries[i].point[a]);
+        }
+    }
+    const QVector3D extent = max - min;
+    const int axis = extent.x() >= extent.y() && extent.x() >= extent.z() ? 0 : (extent.y() >= extent.z() ? 1 : 2);
+
+    const std::size_t mid = begin + (end - begin) / 2;
+    std::nth_element(entries.begin() + static_cast<std::ptrdiff_t>(begin), entries.begin() + static_cast<std::ptrdiff_t>(mid),
+                     entries.begin() + static_cast<std::ptrdiff_t>(end),
+                     [axis](const Entry& a, const Entry& b) { return a.point[axis] < b.point[axis]; });
+    m_split_axis[mid] = static_cast<std::uint8_t>(axis);
+
+    if (spawn_depth > 0) {
+        std::thread left(&KdTree::build_range, this, std::ref(entries), begin, mid, spawn_depth - 1, cancel);
+        build_range(entries, mid + 1, end, spawn_depth - 1, cancel);
+        left.join();
+    } else {
+        build_range(entries, begin, mid, 0, cancel);
+        build_range(entries, mid + 1, end, 0, cancel);
+    }
+}
+
+inline void
+KdTree::knn_range(const std::size_t begin, const std::size_t end, const QVector3D& query, Neighbours& best) const
+{
+    if (end - begin <= leaf_size) {
+        for (std::size_t i=begin; i<end; i++)
+            best.add((m_points[i] - query).lengthSquared(), static_cast<std::uint32_t>(i));
+        return;
+    }
+
+    const std::size_t mid = begin + (end - begin) / 2;
+    const int axis = m_split_axis[mid];
+    const float diff = query[axis] - m_points[mid][axis];
+    best.add((m_points[mid] - query).lengthSquared(), static_cast<std::uint32_t>(mid));
+
+    // Near side first, the far side only if the splitting plane is closer than the worst candidate
+    if (diff < 0.F) {
+        knn_range(begin, mid, query, best);
+        if (diff * diff < best.worst())
+            knn_range(mid + 1, end, query, best);
+    } else {
+        knn_range(mid + 1, end, query, best);
+        if (diff * diff < best.worst())
+            knn_range(begin, mid, query, best);
+    }
+}
+
+inline bool
+KdTree::nearest(const QVector3D& query, std::uint32_t& index, float& squared_distance) const
+{
+    if (m_points.empty())
+        return false;
+
+    Neighbours best;
+    best.k = 1;
+    best.heap.reserve(1);
+    knn_range(0, m_points.size(), query, best);
+
+    index = m_indices[best.heap.front().second];
+    squared_distance = best.heap.front().first;
+    return true;
+}
+
+inline void
+KdTree::knn(const QVector3D& query, const std::size_t k, std::vector<std::uint32_t>& indices, std::vector<float>& squared_distances) const
+{
+    indices.clear();
+    squared_distances.clear();
+    if (m_points.empty() || 0 == k)
+        return;
+
+    Neighbours best;
+    best.k = k;
+    best.heap.reserve(k);
+    knn_range(0, m_points.size(), query, best);
+
+    std::sort_heap(best.heap.begin(), best.heap.end());
+    for (const auto& [squared_distance, i] : best.heap) {
+        indices.emplace_back(m_indices[i]);
+        squared_distances.emplace_back(squared_distance);
+    }
+}
+
+inline void
+KdTree::radius_range(const std::size_t begin, const std::size_t end, const QVector3D& query, const float squared_radius,
+                     std::vector<std::uint32_t>& indices, std::vector<float>& squared_distances) const
+{
+    if (end - begin <= leaf_size) {
+        for (std::size_t i=begin; i<end; i++) {
+            const float d = (m_points[i] - query).lengthSquared();
+            if (d < squared_radius) {
+                indices.emplace_back(m_indices[i]);
+                squared_distances.emplace_back(d);
+            }
+        }
+        return;
+    }
+
+    const std::size_t mid = begin + (end - begin) / 2;
+    const int axis = m_split_axis[mid];
+    const float diff = query[axis] - m_points[mid][axis];
+    const float d = (m_points[mid] - query).lengthSquared();
+    if (d < squared_radius) {
+        indices.emplace_back(m_indices[mid]);
+        squared_distances.emplace_back(d);
+    }
+
+    if (diff < 0.F || diff * diff < squared_radius)
+        radius_range(begin, mid, query, squared_radius, indices, squared_distances);
+    if (diff >= 0.F || diff * diff < squared_radius)
+        radius_range(mid + 1, end, query, squared_radius, indices, squared_distances);
+}
+
+inline void
+KdTree::radius_search(const QVector3D& query, const float radius, std::vector<std::uint32_t>& indices, std::vector<float>& squared_distances) const
+{
+    indices.clear();
+    squared_distances.clear();
+    if (!m_points.empty() && radius > 0.F)
+        radius_range(0, m_points.size(), query, radius * radius, indices, squared_distances);
+}
+
+inline void
+KdTree::knn_batch(const std::vector<QVector3D>& queries, const std::size_t k, std::vector<std::uint32_t>& indices, std::vector<float>& squared_distances) const
+{
+    indices.assign(queries.size() * k, invalid_index);
+    squared_distances.assign(queries.size() * k, std::numeric_limits<float>::max());
+
+    parallel_for(0, queries.size(), 256, [&](const std::size_t begin, const std::size_t end) {
+        std::vector<std::uint32_t> query_indices;
+        std::vector<float> query_distances;
+        for (std::size_t q=begin; q<end; q++) {
+            knn(queries[q], k, query_indices, query_distances);
+            std::copy(query_indices.begin(), query_indices.end(), indices.begin() + static_cast<std::ptrdiff_t>(q * k));
+            std::copy(query_distances.begin(), query_distances.end(), squared_distances.begin() + static_cast<std::ptrdiff_t>(q * k));
+        }
+    });
+}
+
+inline void
+KdTree::radius_batch(const std::vector<QVector3D>& queries, const float radius, std::vector<std::vector<std::uint32_t>>& indices) const
+{
+    indices.resize(queries.size());
+
+    parallel_for(0, queries.size(), 256, [&](const std::size_t begin, const std::size_t end) {
+        std::vector<float> squared_distances;
+        for (std::size_t q=begin; q<end; q++)
+            radius_search(queries[q], radius, indices[q], squared_distances);
+    });
+}
+
+}
+
+#endif // KDTREE_H
@@ -0,0 +1,138 @@
+#ifndef LOCALSOCKET_H
+#define LOCALSOCKET_H
+
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+namespace graphics {
+
+/*!
+ * \brief Local stream sockets (POSIX, Linux only: MSG_NOSIGNAL)
+ * Addresses are "unix:/path/to/socket" for a Unix-domain socket or "tcp:PORT" for TCP on
+ * the loopback interface only.
+ */
+struct LocalSocketAddress
+{
+    bool is_unix {true};
+    std::string path;
+    std::uint16_t port {0};
+
+    static bool parse(const std::string& address, LocalSocketAddress& result)
+    {
+        if (address.rfind("unix:", 0) == 0 && address.size() > 5) {
+            result.is_unix = true;
+            result.path = address.substr(5);
+            return result.path.size() < sizeof(sockaddr_un::sun_path);
+        }
+        if (address.rfind("tcp:", 0) == 0) {
+            result.is_unix = false;
+            try {
+                const int port = std::stoi(address.substr(4));
+                result.port = static_cast<std::uint16_t>(port);
+                return port > 0 && port < 65536;
+            } catch (const std::exception&) {
+                return false;
+            }
+        }
+        return false;
+    }
+};
+
+/*!
+ * \brief open_local_socket
+ * \param address see LocalSocketAddress
+ * \param listening true to bind and listen, false to connect
+ * \return file descriptor, -1 on error
+ */
+inline int
+open_local_socket(const std::string& address, const bool listening)
+{
+    LocalSocketAddress a;
+    if (!LocalSocketAddress::parse(address, a)) {
+        std::cerr << "Invalid socket address " << address << ", expected unix:/path or tcp:PORT" << std::endl;
+        return -1;
+    }
+
+    const int fd = ::socket(a.is_unix ? AF_UNIX : AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+
+    int result = -1;
+    if (a.is_unix) {
+        sockaddr_un addr {};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, a.path.c_str(), sizeof(addr.sun_path) - 1);
+        if (listening)
+            ::unlink(a.path.c_str()); // left behind by a previous run
+        result = listening ? ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr))
+                           : ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    } else {
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(a.port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        const int one = 1;
+        if (listening)
+            ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        else
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // frames are sent in one go
+        result = listening ? ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr))
+                           : ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    }
+
+    if (result == 0 && listening)
+        result = ::listen(fd, 1);
+
+    if (result != 0) {
+        std::cerr << (listening ? "Listening on " : "Connecting to ") << address << " failed: " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+inline bool
+read_exact(const int fd, void* data, std::size_t size)
+{
+    char* ptr = static_cast<char*>(data);
+    while (size > 0) {
+        const ssize_t n = ::recv(fd, ptr, size, 0);
+        if (n < 0 && EINTR == errno)
+            continue; // interrupted by a signal before anything was read
+        if (n <= 0)
+            return false; // closed or shut down
+        ptr += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+inline bool
+write_exact(const int fd, const void* data, std::size_t size)
+{
+    const char* ptr = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t n = ::send(fd, ptr, size, MSG_NOSIGNAL);
+        if (n < 0 && EINTR == errno)
+            continue;
+        if (n <= 0)
+            return false;
+        ptr += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+}
+
+#endif // LOCALSOCKET_H
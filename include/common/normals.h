@@ -0,0 +1,273 @@
+#ifndef NORMALS_H
+#define NORMALS_H
+
+#include <cmath>
+#include <cstring>
+#include <atomic>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <QVector3D>
+
+#include <opengl_helper.hpp>
+#include <parallel.hpp>
+#include <kdtree.h>
+
+namespace graphics {
+
+/*!
+ * \brief compute_organized_normals
+ * Normals of an organized cloud from its image-space neighbours, without any search structure:
+ * the cross product of the horizontal and vertical tangents, central differences where both
+ * neighbours are valid, one-sided ones otherwise. A neighbour whose depth differs by more than
+ * max_depth_jump (relative to the depth of the point) lies across a depth discontinuity and is
+ * not used. Normals face the sensor at the origin, invalid points get a zero normal.
+ * \return false if the cloud is not organized
+ */
+inline bool
+compute_organized_normals(VertexData& vertex_data, const float max_depth_jump = 0.05F)
+{
+    if (!vertex_data.is_organized())
+        return false;
+
+    const std::size_t width = vertex_data.width;
+    const std::size_t height = vertex_data.height;
+    const QVector3D* positions = vertex_data.positions.data();
+    vertex_data.normals.resize(vertex_data.positions.size());
+    QVector3D* normals = vertex_data.normals.data();
+
+    parallel_for(0, height, std::max<std::size_t>(1, (1 << 14) / width), [&](const std::size_t row_begin, const std::size_t row_end) {
+        // valid and on the same surface as p
+        auto is_neighbour = [max_depth_jump](const QVector3D& p, const QVector3D& q) {
+            return is_valid_point(q) && std::fabs(q.z() - p.z()) <= max_depth_jump * std::fabs(p.z());
+        };
+
+        for (std::size_t v=row_begin; v<row_end; v++) {
+            for (std::size_t u=0; u<width; u++) {
+                const std::size_t i = v * width + u;
+                const QVector3D& p = positions[i];
+                normals[i] = QVector3D();
+                if (!is_valid_point(p))
+                    continue;
+
+                const bool has_left = u > 0 && is_neighbour(p, positions[i - 1]);
+                const bool has_right = u + 1 < width && is_neighbour(p, positions[i + 1]);
+                const bool has_up = v > 0 && is_neighbour(p, positions[i - width]);
+                const bool has_down = v + 1 < height && is_neighbour(p, positions[i + width]);
+                if ((!has_left && !has_right) || (!has_up && !has_down))
+                    continue;
+
+                const QVector3D tangent_u = (has_right ? positions[i + 1] : p) - (has_left ? positions[i - 1] : p);
+                const QVector3D tangent_v = (has_down ? positions[i + width] : p) - (has_up ? positions[i - width] : p);
+                QVector3D n = QVector3D::crossProduct(tangent_u, tangent_v);
+
+                const float length = n.length();
+                if (length <= 0.F)
+                    continue;
+                n /= length;
+                normals[i] = QVector3D::dotProduct(n, p) > 0.F ? -n : n;
+            }
+        }
+    });
+
+    return true;
+}
+
+/*!
+ * \brief smallest_eigenvector
+ * Unit eigenvector of the smallest eigenvalue of a symmetric 3x3 matrix, in closed form: the
+ * eigenvalues from the trigonometric solution of the characteristic cubic, the eigenvector as the
+ * longest cross product of two rows of (A - lambda I).
+ * \param m xx, xy, xz, yy, yz, zz
+ * \return a zero vector if the eigenvector is not unique (isotropic or linear neighbourhood)
+ */
+inline QVector3D
+smallest_eigenvector(const double m[6])
+{
+    const double off_diagonal = m[1] * m[1] + m[2] * m[2] + m[4] * m[4];
+    const double q = (m[0] + m[3] + m[5]) / 3.;
+    const double a = m[0] - q;
+    const double d = m[3] - q;
+    const double f = m[5] - q;
+    const double p = std::sqrt((a * a + d * d + f * f + 2. * off_diagonal) / 6.);
+    if (p <= 0.)
+        return QVector3D();
+
+    // det((A - qI) / p) / 2, in [-1, 1] up to rounding
+    const double r = (a * (d * f - m[4] * m[4]) - m[1] * (m[1] * f - m[4] * m[2]) + m[2] * (m[1] * m[4] - d * m[2])) / (2. * p * p * p);
+    const double phi = std::acos(std::clamp(r, -1., 1.)) / 3.;
+    const double lambda = q + 2. * p * std::cos(phi + 2. * M_PI / 3.);
+
+    const double rows[3][3] = {{m[0] - lambda, m[1], m[2]}, {m[1], m[3] - lambda, m[4]}, {m[2], m[4], m[5] - lambda}};
+    auto cross = [](const double* u, const double* v, double* w) {
+        w[0] = u[1] * v[2] - u[2] * v[1];
+        w[1] = u[2] * v[0] - u[0] * v[2];
+        w[2] = u[0] * v[1] - u[1] * v[0];
+        return w[0] * w[0] + w[1] * w[1] + w[2] * w[2];
+    };
+    double best[3];
+    double candidate[3];
+    double best_length = cross(rows[0], rows[1], best);
+    for (const auto& [i, j] : {std::pair<int, int>{0, 2}, std::pair<int, int>{1, 2}}) {
+        const double length = cross(rows[i], rows[j], candidate);
+        if (length > best_length) {
+            best_length = length;
+            std::memcpy(best, candidate, sizeof(best));
+        }
+    }
+    if (best_length <= 1e-10 * p * p * p * p)
+        return QVector3D();
+
+    const double inverse = 1. / std::sqrt(best_length);
+    return QVector3D(static_cast<float>(best[0] * inverse), static_cast<float>(best[1] * inverse), static_cast<float>(best[2] * inverse));
+}
+
+/*!
+ * \brief estimate_normals
+ * Normals of an unstructured cloud by PCA: the covariance of the k nearest neighbours of every
+ * point (itself included) and its smallest eigenvector, see smallest_eigenvector(...). Points are
+ * split over the hardware threads, the tree is only read. Normals face the viewpoint, points with
+ * fewer than 3 neighbours or a degenerate neighbourhood and invalid points get a zero normal.
+ * \param tree built over positions
+ * \param viewpoint scan origin or camera position the normals are turned to
+ * \param cancel checked every few thousand points, an empty vector is returned when it is set
+ */
+inline std::vector<QVector3D>
+estimate_normals(const std::vector<QVector3D>& positions, const KdTree& tree, const std::size_t k, const QVector3D& viewpoint,
+                 const std::atomic<bool>* cancel = nullptr)
+{
+    std::vector<QVector3D> normals(positions.size());
+    auto is_cancelled = [cancel]() { return nullptr != cancel && *cancel; };
+
+    parallel_for(0, positions.size(), 4096, [&](const std::size_t begin, const std::size_t end) {
+        std::vector<std::uint32_t> indices;
+        std::vector<float> squared_distances;
+        for (std::size_t i=begin; i<end; i++) {
+            if (0 == (i & 4095) && is_cancelled())
+                return;
+            const QVector3D& p = positions[i];
+            if (!is_valid_point(p))
+                continue;
+
+            tree.knn(p, k, indices, squared_distances);
+            if (indices.size() < 3)
+                continue;
+
+            // Centered on the point first, which keeps the sums small for clouds far from the origin
+            double mean[3] = {0., 0., 0.};
+            double m[6] = {0., 0., 0., 0., 0., 0.};
+            for (const std::uint32_t j : indices) {
+                const double x = positions[j].x() - p.x();
+                const double y = positions[j].y() - p.y();
+                const double z = positions[j].z() - p.z();
+                mean[0] += x;
+                mean[1] += y;
+                mean[2] += z;
+                m[0] += x * x;
+                m[1] += x * y;
+                m[2] += x * z;
+                m[3] += y * y;
+                m[4] += y * z;
+                m[5] += z * z;
+            }
+            const double n = static_cast<double>(indices.size());
+            for (double& v : mean)
+                v /= n;
+            m[0] = m[0] / n - mean[0] * mean[0];
+            m[1] = m[1] / n - mean[0] * mean[1];
+            m[2] = m[2] / n - mean[0] * mean[2];
+            m[3] = m[3] / n - mean[1] * mean[1];
+            m[4] = m[4] / n - mean[1] * mean[2];
+            m[5] = m[5] / n - mean[2] * mean[2];
+
+            const QVector3D normal = smallest_eigenvector(m);
+            normals[i] = QVector3D::dotProduct(normal, viewpoint - p) < 0.F ? -normal : normal;
+        }
+    });
+
+    if (is_cancelled())
+        return {};
+    return normals;
+}
+
+/*!
+ * \brief Sidecar cache of estimated normals
+ * <file>.normals next to the file: a header with the size and last write time of the file, the
+ * number of points and the k used, then the normals as x, y, z floats. A cache whose header does
+ * not match the file any more is ignored.
+ */
+struct NormalsCacheHeader
+{
+    char magic[8] {'P', 'C', 'N', 'O', 'R', 'M', 'S', '1'};
+    std::uint64_t file_size {0};
+    std::int64_t modified {0};
+    std::uint64_t count {0};
+    std::uint64_t k {0};
+};
+
+inline std::string
+normals_cache_file(const std::string& file_name)
+{
+    return file_name + ".normals";
+}
+
+inline bool
+normals_cache_header(const std::string& file_name, const std::size_t count, const std::size_t k, NormalsCacheHeader& header)
+{
+    std::error_code ec;
+    const std::uintmax_t size = std::filesystem::file_size(file_name, ec);
+    if (ec)
+        return false;
+    const auto modified = std::filesystem::last_write_time(file_name, ec);
+    if (ec)
+        return false;
+
+    header.file_size = static_cast<std::uint64_t>(size);
+    header.modified = static_cast<std::int64_t>(modified.time_since_epoch().count());
+    header.count = count;
+    header.k = k;
+    return true;
+}
+
+inline bool
+read_normals_cache(const std::string& file_name, const std::size_t count, const std::size_t k, std::vector<QVector3D>& normals)
+{
+    NormalsCacheHeader expected;
+    if (!normals_cache_header(file_name, count, k, expected))
+        return false;
+
+    std::ifstream file(normals_cache_file(file_name), std::ios::binary);
+    NormalsCacheHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || 0 != std::memcmp(&header, &expected, sizeof(header)))
+        return false;
+
+    std::vector<QVector3D> cached(count);
+    if (!file.read(reinterpret_cast<char*>(cached.data()), static_cast<std::streamsize>(count * sizeof(QVector3D))))
+        return false;
+
+    normals = std::move(cached);
+    return true;
+}
+
+inline bool
+write_normals_cache(const std::string& file_name, const std::size_t k, const std::vector<QVector3D>& normals)
+{
+    NormalsCacheHeader header;
+    if (!normals_cache_header(file_name, normals.size(), k, header))
+        return false;
+
+    std::ofstream file(normals_cache_file(file_name), std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        return false; // read-only directory, estimated again next time
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(normals.data()), static_cast<std::streamsize>(normals.size() * sizeof(QVector3D)));
+    return file.good();
+}
+
+}
+
+#endif // NORMALS_H
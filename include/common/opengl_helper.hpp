@@ -2,6 +2,8 @@
 #define OPENGL_HELPER_HPP
 
 #include <iostream>
+#include <cstring>
+#include <cstdint>
 
 #include <QOpenGLContext>
 #include <QOpenGLFunctions>
@@ -9,6 +11,8 @@
 #include <QOpenGLFramebufferObject>
 #include <QImage>
 
+#include <pointattribute.h>
+
 namespace graphics {
 
 //class Texture {
@@ -18,12 +22,46 @@ namespace graphics {
 //    std::string path;
 //};
 
+/*!
+ * \brief is_valid_point
+ * Organized clouds mark the invalid points with NaN. The exponent bits are tested instead of
+ * std::isfinite(...) because the release build uses -Ofast, which assumes there are no NaNs.
+ */
+inline bool
+is_valid_point(const QVector3D& p)
+{
+    const float coordinates[3] = {p.x(), p.y(), p.z()};
+    for (const float c : coordinates) {
+        std::uint32_t bits = 0;
+        std::memcpy(&bits, &c, sizeof(bits));
+        if ((bits & 0x7f800000U) == 0x7f800000U)
+            return false;
+    }
+    return true;
+}
+
 struct VertexData
 {
     std::vector<QVector3D> positions;
     std::vector<QVector4D> colors;
     std::vector<QVector3D> normals;
     std::vector<QVector2D> tex_coords;
+    std::vector<PointAttribute> attributes; // extra vertex properties, decoded on demand
+    tinyply::Type color_type {tinyply::Type::FLOAT32}; // type of the colour properties in the source file
+    bool has_alpha {true};
+    std::size_t width {0};  // organized clouds, e.g. back-projected depth images: positions are height rows of width points,
+    std::size_t height {0}; // invalid points are NaN so that the grid is kept. 0 for unorganized clouds
+
+    bool is_organized() const { return width > 0 && width * height == positions.size(); }
+
+    PointAttribute* find_attribute(const std::string& name)
+    {
+        for (auto& a : attributes) {
+            if (a.name == name)
+                return &a;
+        }
+        return nullptr;
+    }
 };
 
 
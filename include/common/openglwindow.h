@@ -42,17 +42,25 @@ public:
     explicit OpenGLWindow(std::shared_ptr<QOpenGLContext> opengl_context = nullptr, QWindow *parent = nullptr);
 //    virtual ~OpenGLWindow() {}
 
+    /*!
+     * \brief create_format
+     * \param samples of the default framebuffer, multisampling can then be switched off per frame with GL_MULTISAMPLE
+     * \param swap_interval 1 waits for the VSync, 0 renders as fast as possible
+     */
     static inline
-    QSurfaceFormat create_format() {
+    QSurfaceFormat create_format(const int samples = 4, const int swap_interval = 0) {
         //******** OpenGL surface creation for QWindow START ********
         QSurfaceFormat format;
-        format.setSamples(16);
+        format.setSamples(samples);
         format.setSwapBehavior(QSurfaceFormat::DefaultSwapBehavior);
-        format.setSwapInterval(1); // attempt to switch ON the VSync. If =1 then VSync ON. Parameter defines number of frames of delay.
+        format.setSwapInterval(swap_interval); // attempt to switch ON the VSync. If =1 then VSync ON. Parameter defines number of frames of delay.
 
         return format;
     }
 
+    // Samples of the default framebuffer actually obtained, 0 before the context is created
+    int samples() const { return m_context ? m_context->format().samples() : 0; }
+
     void set_opengl_context(std::shared_ptr<QOpenGLContext> ctx) { m_context = ctx; m_gl_initialized = false; }
     std::shared_ptr<QOpenGLContext> opengl_context() { return m_context; }
 
@@ -0,0 +1,102 @@
+#ifndef OUTLIERFILTER_H
+#define OUTLIERFILTER_H
+
+#include <vector>
+#include <atomic>
+#include <cmath>
+#include <algorithm>
+
+#include <QVector3D>
+
+#include <opengl_helper.hpp>
+#include <kdtree.h>
+#include <parallel.hpp>
+
+namespace graphics {
+
+/*!
+ * \brief statistical_outlier_mask
+ * Statistical outlier removal: the mean distance of every point to its k nearest neighbours is
+ * compared to the mean and standard deviation of these distances over the whole cloud, points
+ * further than mean + sigma * stddev are outliers. The queries run in parallel over the k-d tree
+ * and the statistics are reduced per chunk, nothing is shared between the threads but the tree.
+ * \param tree built over positions
+ * \param cancel checked between chunks, an empty mask is returned when it is set
+ * \return one byte per point, 1 to keep it, 0 for outliers and invalid points
+ */
+inline std::vector<std::uint8_t>
+statistical_outlier_mask(const std::vector<QVector3D>& positions, const KdTree& tree, const std::size_t k, const float sigma,
+                         const std::atomic<bool>* cancel = nullptr)
+{
+    const std::size_t count = positions.size();
+    if (0 == count || tree.size() < 2 || 0 == k)
+        return std::vector<std::uint8_t>(count, 1);
+
+    std::vector<float> mean_distances(count, -1.F);
+    const std::size_t grain = 4096;
+    const std::size_t chunks_count = (count + grain - 1) / grain;
+    std::vector<double> chunk_sum(chunks_count, 0.);
+    std::vector<double> chunk_squared_sum(chunks_count, 0.);
+    std::vector<std::size_t> chunk_valid(chunks_count, 0);
+
+    parallel_for(0, count, grain, [&](const std::size_t begin, const std::size_t end) {
+        if (nullptr != cancel && *cancel)
+            return;
+
+        std::vector<std::uint32_t> indices;
+        std::vector<float> squared_distances;
+        const std::size_t c = begin / grain;
+        for (std::size_t i=begin; i<end; i++) {
+            if (!is_valid_point(positions[i]))
+                continue;
+
+            // The point itself is its own nearest neighbour
+            tree.knn(positions[i], k + 1, indices, squared_distances);
+            float sum = 0.F;
+            std::size_t n = 0;
+            for (std::size_t j=0; j<indices.size(); j++) {
+                if (indices[j] != i) {
+                    sum += std::sqrt(squared_distances[j]);
+                    n++;
+                }
+            }
+            if (0 == n)
+                continue;
+
+            const float mean = sum / static_cast<float>(n);
+            mean_distances[i] = mean;
+            chunk_sum[c] += mean;
+            chunk_squared_sum[c] += static_cast<double>(mean) * mean;
+            chunk_valid[c]++;
+        }
+    });
+    if (nullptr != cancel && *cancel)
+        return {};
+
+    double sum = 0.;
+    double squared_sum = 0.;
+    std::size_t valid = 0;
+    for (std::size_t c=0; c<chunks_count; c++) {
+        sum += chunk_sum[c];
+        squared_sum += chunk_squared_sum[c];
+        valid += chunk_valid[c];
+    }
+
+    std::vector<std::uint8_t> keep(count, 0);
+    if (0 == valid)
+        return keep;
+
+    const double mean = sum / static_cast<double>(valid);
+    const double variance = std::max(0., squared_sum / static_cast<double>(valid) - mean * mean);
+    const float threshold = static_cast<float>(mean + static_cast<double>(sigma) * std::sqrt(variance));
+
+    parallel_for(0, count, [&](const std::size_t begin, const std::size_t end) {
+        for (std::size_t i=begin; i<end; i++)
+            keep[i] = mean_distances[i] >= 0.F && mean_distances[i] <= threshold ? 1 : 0;
+    });
+    return keep;
+}
+
+}
+
+#endif // OUTLIERFILTER_H
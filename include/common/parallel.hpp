@@ -0,0 +1,91 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace graphics {
+
+inline std::size_t
+hardware_threads()
+{
+    const unsigned int n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : static_cast<std::size_t>(n);
+}
+
+/*!
+ * \brief parallel_for
+ * Splits [begin, end) into chunks of `grain` items which are handed out dynamically to
+ * one worker per hardware thread; fn(chunk_begin, chunk_end) is called for every chunk.
+ * The first exception thrown by a worker is rethrown in the calling thread.
+ * \param begin
+ * \param end
+ * \param grain number of items per chunk
+ * \param fn
+ */
+template <typename Function>
+inline void
+parallel_for(const std::size_t begin, const std::size_t end, const std::size_t grain, Function&& fn)
+{
+    if (end <= begin)
+        return;
+
+    const std::size_t chunk = std::max<std::size_t>(1, grain);
+    const std::size_t chunks_count = (end - begin + chunk - 1) / chunk;
+    const std::size_t threads_count = std::min(hardware_threads(), chunks_count);
+
+    if (threads_count <= 1) {
+        fn(begin, end);
+        return;
+    }
+
+    std::atomic<std::size_t> next_chunk {0};
+    std::exception_ptr error {nullptr};
+    std::mutex error_mutex;
+
+    auto worker = [&]() {
+        try {
+            for (std::size_t c = next_chunk++; c < chunks_count; c = next_chunk++) {
+                const std::size_t chunk_begin = begin + c * chunk;
+                fn(chunk_begin, std::min(end, chunk_begin + chunk));
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error)
+                error = std::current_exception();
+            next_chunk = chunks_count;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(threads_count - 1);
+    for (std::size_t t=1; t<threads_count; t++)
+        threads.emplace_back(worker);
+    worker(); // the calling thread takes part as well
+
+    for (auto& t : threads)
+        t.join();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+/*!
+ * \brief parallel_for
+ * Same as above with the grain chosen to give every hardware thread a few chunks.
+ */
+template <typename Function>
+inline void
+parallel_for(const std::size_t begin, const std::size_t end, Function&& fn)
+{
+    const std::size_t grain = std::max<std::size_t>(1024, (end - begin) / (hardware_threads() * 8) + 1);
+    parallel_for(begin, end, grain, std::forward<Function>(fn));
+}
+
+}
+
+#endif // PARALLEL_HPP
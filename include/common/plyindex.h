@@ -0,0 +1,170 @@
+#ifndef PLYINDEX_H
+#define PLYINDEX_H
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <plyloader.h>
+#include <parallel.hpp>
+
+namespace graphics {
+
+struct PlyIndexEntry
+{
+    PlyInfo info;
+    std::int64_t modified {0}; // last write time of the file when it was probed
+};
+
+/*!
+ * \brief The PlyIndex class
+ * Header-only metadata of every PLY file in a directory. The index is persisted next to the
+ * files, so that on the next build only new or modified files are probed again.
+ */
+class PlyIndex
+{
+public:
+    static constexpr const char* index_file_name = ".qt-pc-viewer-index.tsv";
+
+    bool build(const std::string& directory);
+
+    const std::vector<PlyIndexEntry>& entries() const { return m_entries; }
+    const std::string& directory() const { return m_directory; }
+    std::size_t probed_count() const { return m_probed_count; }
+    double build_time() const { return m_build_time; } // ms
+
+private:
+    std::unordered_map<std::string, PlyIndexEntry> load(const std::filesystem::path& index_path) const;
+    bool save(const std::filesystem::path& index_path) const;
+
+    std::string m_directory;
+    std::vector<PlyIndexEntry> m_entries;
+    std::size_t m_probed_count {0};
+    double m_build_time {0.};
+};
+
+inline bool
+PlyIndex::build(const std::string& directory)
+{
+    namespace fs = std::filesystem;
+    manual_timer timer;
+    timer.start();
+
+    m_directory = directory;
+    m_entries.clear();
+    m_probed_count = 0;
+
+    std::error_code ec;
+    if (!fs::is_directory(directory, ec))
+        return false;
+
+    const fs::path index_path = fs::path(directory) / index_file_name;
+    std::unordered_map<std::string, PlyIndexEntry> persisted = load(index_path);
+
+    std::vector<std::size_t> to_probe;
+    for (const auto& item : fs::directory_iterator(directory, ec)) {
+        if (!item.is_regular_file(ec))
+            continue;
+        std::string extension = item.path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        if (extension != ".ply")
+            continue;
+
+        PlyIndexEntry entry;
+        entry.info.file_name = item.path().string();
+        entry.info.file_size = static_cast<std::size_t>(item.file_size(ec));
+        entry.modified = static_cast<std::int64_t>(item.last_write_time(ec).time_since_epoch().count());
+
+        auto it = persisted.find(item.path().filename().string());
+        if (it != persisted.end() && it->second.modified == entry.modified && it->second.info.file_size == entry.info.file_size) {
+            entry.info = it->second.info;
+            entry.info.file_name = item.path().string();
+        } else {
+            to_probe.emplace_back(m_entries.size());
+        }
+        m_entries.emplace_back(entry);
+    }
+
+    // Each probe reads only a header, files are handed out to all cores
+    parallel_for(0, to_probe.size(), 16, [this, &to_probe](const std::size_t begin, const std::size_t end) {
+        for (std::size_t i=begin; i<end; i++) {
+            PlyIndexEntry& entry = m_entries[to_probe[i]];
+            entry.info = probe_ply(entry.info.file_name);
+        }
+    });
+    m_probed_count = to_probe.size();
+
+    std::sort(m_entries.begin(), m_entries.end(), [](const PlyIndexEntry& a, const PlyIndexEntry& b) { return a.info.file_name < b.info.file_name; });
+
+    if (m_probed_count > 0 || persisted.size() != m_entries.size())
+        save(index_path);
+
+    timer.stop();
+    m_build_time = timer.get();
+    std::cout << "Indexed " << m_entries.size() << " PLY files in " << directory << " (" << m_probed_count << " probed) in " << m_build_time << " ms" << std::endl;
+
+    return true;
+}
+
+// One line per file: name, size, modified, valid, binary, big endian, vertex count, header size, properties
+inline std::unordered_map<std::string, PlyIndexEntry>
+PlyIndex::load(const std::filesystem::path& index_path) const
+{
+    std::unordered_map<std::string, PlyIndexEntry> entries;
+    std::ifstream file(index_path);
+    std::string line;
+
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream ls(line);
+        std::string name, properties;
+        PlyIndexEntry entry;
+        if (!std::getline(ls, name, '\t'))
+            continue;
+        ls >> entry.info.file_size >> entry.modified >> entry.info.valid >> entry.info.is_binary
+           >> entry.info.is_big_endian >> entry.info.vertex_count >> entry.info.header_size;
+        if (ls.fail())
+            continue;
+        ls >> properties;
+
+        std::istringstream ps(properties);
+        std::string p;
+        while (std::getline(ps, p, ','))
+            entry.info.properties.emplace_back(p);
+
+        entries[name] = entry;
+    }
+
+    return entries;
+}
+
+inline bool
+PlyIndex::save(const std::filesystem::path& index_path) const
+{
+    std::ofstream file(index_path, std::ios::trunc);
+    if (!file.is_open())
+        return false; // read-only directory, the index is rebuilt next time
+
+    file << "# qt-pc-viewer PLY index v1\n";
+    for (const auto& entry : m_entries) {
+        const PlyInfo& info = entry.info;
+        file << std::filesystem::path(info.file_name).filename().string() << '\t'
+             << info.file_size << ' ' << entry.modified << ' ' << info.valid << ' ' << info.is_binary << ' '
+             << info.is_big_endian << ' ' << info.vertex_count << ' ' << info.header_size << ' ';
+        for (std::size_t i=0; i<info.properties.size(); i++)
+            file << (i > 0 ? "," : "") << info.properties[i];
+        file << '\n';
+    }
+
+    return file.good();
+}
+
+}
+
+#endif // PLYINDEX_H
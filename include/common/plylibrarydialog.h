@@ -0,0 +1,167 @@
+#ifndef PLYLIBRARYDIALOG_H
+#define PLYLIBRARYDIALOG_H
+
+#include <QDialog>
+#include <QLineEdit>
+#include <QLabel>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+
+#include <plyindex.h>
+
+class PlyLibraryDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    PlyLibraryDialog(QWidget *parent = nullptr)
+        : QDialog(parent)
+    {
+        setWindowTitle("PLY Library");
+        setWindowFlags(Qt::Dialog);
+
+        setModal(false);
+        setAttribute(Qt::WA_ShowModal, false); // Set the WA_ShowModal property
+        setWindowModality(Qt::NonModal);
+
+        constexpr int window_width = 900;
+        constexpr int window_height = 500;
+        resize(window_width, window_height);
+        setMinimumSize(QSize(window_width/2, window_height/2));
+
+        QPushButton* directory_btn = new QPushButton("Directory...");
+        m_directory_lbl = new QLabel;
+        m_filter_ledit = new QLineEdit;
+        m_filter_ledit->setPlaceholderText("Filter by name or property, e.g. intensity");
+
+        QHBoxLayout *top_layout = new QHBoxLayout;
+        top_layout->addWidget(directory_btn);
+        top_layout->addWidget(m_directory_lbl);
+        top_layout->addStretch();
+        top_layout->addWidget(m_filter_ledit);
+
+        m_table = new QTableWidget;
+        m_table->setColumnCount(column_count);
+        m_table->setHorizontalHeaderLabels({"Name", "Points", "Format", "Size [MB]", "Load [s]", "Memory [MB]", "Properties"});
+        m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+        m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        m_table->horizontalHeader()->setStretchLastSection(true);
+
+        m_status_lbl = new QLabel;
+
+        QVBoxLayout *main_layout = new QVBoxLayout;
+        main_layout->addLayout(top_layout);
+        main_layout->addWidget(m_table);
+        main_layout->addWidget(m_status_lbl);
+        setLayout(main_layout);
+
+        connect(directory_btn, &QPushButton::clicked, this, &PlyLibraryDialog::slot_choose_directory);
+        connect(m_filter_ledit, &QLineEdit::textChanged, this, &PlyLibraryDialog::slot_apply_filter);
+        connect(m_table, &QTableWidget::cellDoubleClicked, this, &PlyLibraryDialog::slot_cell_double_clicked);
+    }
+
+    void index_directory(const QString& directory);
+
+signals:
+    void sig_open_file(const QString& ply_path);
+
+public slots:
+    void slot_choose_directory();
+    void slot_apply_filter(const QString& text);
+    void slot_cell_double_clicked(int row, int column);
+
+private:
+    enum columns { Name, Points, Format, Size, Load, Memory, Properties, column_count };
+
+    QTableWidgetItem* create_number_item(const double v, const int precision=0);
+
+    graphics::PlyIndex m_index;
+    QTableWidget* m_table {nullptr};
+    QLineEdit* m_filter_ledit {nullptr};
+    QLabel* m_directory_lbl {nullptr};
+    QLabel* m_status_lbl {nullptr};
+};
+
+inline
+QTableWidgetItem* PlyLibraryDialog::create_number_item(const double v, const int precision)
+{
+    // Numbers stored as data, not text, so the columns sort numerically
+    QTableWidgetItem* item = new QTableWidgetItem;
+    item->setData(Qt::DisplayRole, precision > 0 ? QString::number(v, 'f', precision).toDouble() : v);
+    return item;
+}
+
+inline
+void PlyLibraryDialog::index_directory(const QString& directory)
+{
+    m_index.build(directory.toStdString());
+    m_directory_lbl->setText(directory);
+
+    m_table->setSortingEnabled(false); // rows would move while being filled
+    m_table->clearContents();
+    m_table->setRowCount(static_cast<int>(m_index.entries().size()));
+
+    int row = 0;
+    for (const auto& entry : m_index.entries()) {
+        const graphics::PlyInfo& info = entry.info;
+
+        QString properties;
+        for (std::size_t i=0; i<info.properties.size(); i++)
+            properties += (i > 0 ? " " : "") + QString::fromStdString(info.properties[i]);
+
+        QTableWidgetItem* name_item = new QTableWidgetItem(QFileInfo(QString::fromStdString(info.file_name)).fileName());
+        name_item->setData(Qt::UserRole, QString::fromStdString(info.file_name));
+        name_item->setToolTip(QString::fromStdString(info.file_name));
+
+        QString format = !info.valid ? "invalid" : !info.is_binary ? "ascii" : info.is_big_endian ? "binary BE" : "binary LE";
+
+        m_table->setItem(row, Name, name_item);
+        m_table->setItem(row, Points, create_number_item(static_cast<double>(info.vertex_count)));
+        m_table->setItem(row, Format, new QTableWidgetItem(format));
+        m_table->setItem(row, Size, create_number_item(static_cast<double>(info.file_size) * 1e-6, 2));
+        m_table->setItem(row, Load, create_number_item(info.estimated_load_time(), 2));
+        m_table->setItem(row, Memory, create_number_item(static_cast<double>(info.estimated_memory()) * 1e-6, 1));
+        m_table->setItem(row, Properties, new QTableWidgetItem(properties));
+        row++;
+    }
+
+    m_table->setSortingEnabled(true);
+    slot_apply_filter(m_filter_ledit->text());
+
+    m_status_lbl->setText(QString("%1 files, %2 probed, indexed in %3 ms")
+                          .arg(m_index.entries().size()).arg(m_index.probed_count()).arg(m_index.build_time(), 0, 'f', 1));
+}
+
+inline
+void PlyLibraryDialog::slot_choose_directory()
+{
+    const QString directory = QFileDialog::getExistingDirectory(this, tr("Index PLY directory"), "../resources/pointclouds/");
+    if (!directory.isEmpty())
+        index_directory(directory);
+}
+
+inline
+void PlyLibraryDialog::slot_apply_filter(const QString& text)
+{
+    for (int row = 0; row < m_table->rowCount(); ++row) {
+        const bool match = text.isEmpty()
+                || m_table->item(row, Name)->text().contains(text, Qt::CaseInsensitive)
+                || m_table->item(row, Properties)->text().contains(text, Qt::CaseInsensitive);
+        m_table->setRowHidden(row, !match);
+    }
+}
+
+inline
+void PlyLibraryDialog::slot_cell_double_clicked(int row, int column)
+{
+    Q_UNUSED(column);
+    const QTableWidgetItem* item = m_table->item(row, Name);
+    if (item)
+        Q_EMIT sig_open_file(item->data(Qt::UserRole).toString());
+}
+
+#endif // PLYLIBRARYDIALOG_H
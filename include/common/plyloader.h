@@ -49,7 +49,7 @@ struct memory_buffer : public std::streambuf
 
     pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
     {
-        if (dir == std::ios_base::cur) gbump(static_cast<int>(off));
+        if (dir == std::ios_base::cur) setg(p_start, gptr() + off, p_end); // gbump() takes an int, too small for big files
         else setg(p_start, (dir == std::ios_base::beg ? p_start : p_end) + off, p_end);
         return gptr() - p_start;
     }
@@ -76,32 +76,176 @@ public:
     const double & get() { return timestamp; }
 };
 
-inline bool write_ply(const std::string& filename, const VertexData& vertex_data, const bool is_binary = true)
+/*!
+ * \brief has_ply_properties
+ * \return true if all the scalar properties exist in the element and share the same type,
+ * so they can be requested together without tinyply throwing
+ */
+inline bool has_ply_properties(const tinyply::PlyElement& element, const std::vector<std::string>& names)
 {
+    tinyply::Type type = tinyply::Type::INVALID;
+    for (const auto& name : names) {
+        auto it = std::find_if(element.properties.begin(), element.properties.end(), [&name](const tinyply::PlyProperty& p) { return p.name == name; });
+        if (it == element.properties.end() || it->isList)
+            return false;
+        if (tinyply::Type::INVALID != type && type != it->propertyType) {
+            std::cerr << "\tSkipping property " << name << ": properties requested together must share the same type" << std::endl;
+            return false;
+        }
+        type = it->propertyType;
+    }
+    return true;
+}
+
+inline bool is_standard_vertex_property(const std::string& name)
+{
+    static const std::vector<std::string> standard_names = {"x", "y", "z", "nx", "ny", "nz",
+                                                            "red", "green", "blue", "alpha",
+                                                            "r", "g", "b", "a", "u", "v"};
+    return std::find(standard_names.begin(), standard_names.end(), name) != standard_names.end();
+}
+
+/*!
+ * \brief load_ply_attributes
+ * Decodes vertex property columns of the file into the attributes (in their source types), in a
+ * single pass over the payload. All other properties are skipped by the parser.
+ * \param file_name
+ * \param attributes descriptors filled by read_ply(...)
+ * \return true if every column was loaded
+ */
+inline bool load_ply_attributes(const std::string& file_name, const std::vector<PointAttribute*>& attributes)
+{
+    if (attributes.empty())
+        return true;
+
     std::setlocale(LC_ALL, "C");
-    tinyply::PlyFile ply_file;
 
-    ply_file.add_properties_to_element("vertex", { "x", "y", "z" },
-//        tinyply::Type::FLOAT32, vertex_data.positions.size(), reinterpret_cast<std::uint8_t*>(vertex_data.positions.data()), tinyply::Type::INVALID, 0);
-         tinyply::Type::FLOAT32, vertex_data.positions.size(), (std::uint8_t*)(vertex_data.positions.data()), tinyply::Type::INVALID, 0);
+    try
+    {
+        std::ifstream file_stream(file_name, std::ios::binary);
+        if (file_stream.fail()) throw std::runtime_error("file_stream failed to open " + file_name);
+
+        tinyply::PlyFile file;
+        file.parse_header(file_stream);
+
+        // A scalar property with a non-zero hint is allocated up front, so the payload is parsed only once
+        std::vector<std::shared_ptr<tinyply::PlyData>> columns;
+        columns.reserve(attributes.size());
+        for (const PointAttribute* attribute : attributes)
+            columns.emplace_back(file.request_properties_from_element("vertex", { attribute->name }, 1));
+
+        manual_timer read_timer;
+        read_timer.start();
+        file.read(file_stream);
+        read_timer.stop();
 
-    ply_file.add_properties_to_element("vertex", { "red", "green", "blue", "alpha" },
-          tinyply::Type::FLOAT32, vertex_data.colors.size(), (std::uint8_t*)(vertex_data.colors.data()), tinyply::Type::INVALID, 0);
+        for (std::size_t i=0; i<attributes.size(); i++) {
+            PointAttribute& attribute = *attributes[i];
+            attribute.type = columns[i]->t;
+            attribute.data.resize(columns[i]->buffer.size_bytes());
+            std::memcpy(attribute.data.data(), columns[i]->buffer.get(), columns[i]->buffer.size_bytes());
+            std::cout << "\tRead attribute " << attribute.name << " (" << attribute.size() << " values)" << std::endl;
+        }
+        std::cout << "\t" << attributes.size() << " attribute(s) read in " << read_timer.get() << " ms" << std::endl;
+    }
+    catch (const std::exception & e)
+    {
+        std::cerr << "Caught tinyply exception: " << e.what() << std::endl;
+        return false;
+    }
 
-    ply_file.add_properties_to_element("vertex", { "nx", "ny", "nz" },
-          tinyply::Type::FLOAT32, vertex_data.normals.size(), (std::uint8_t*)(vertex_data.normals.data()), tinyply::Type::INVALID, 0);
+    return std::all_of(attributes.begin(), attributes.end(), [](const PointAttribute* a) { return a->is_loaded(); });
+}
 
-    ply_file.add_properties_to_element("vertex", { "u", "v" },
-          tinyply::Type::FLOAT32, vertex_data.tex_coords.size() , (std::uint8_t*)(vertex_data.tex_coords.data()), tinyply::Type::INVALID, 0);
+/*!
+ * \brief load_ply_attribute
+ * Decodes a single vertex property column of the file, see load_ply_attributes(...)
+ */
+inline bool load_ply_attribute(const std::string& file_name, PointAttribute& attribute)
+{
+    return load_ply_attributes(file_name, { &attribute });
+}
 
+/*!
+ * \brief The PlyInfo struct
+ * Metadata of a PLY file gathered from its header only.
+ */
+struct PlyInfo
+{
+    std::string file_name;
+    bool valid {false};
+    bool is_binary {false};
+    bool is_big_endian {false};
+    std::size_t vertex_count {0};
+    std::size_t file_size {0};   // bytes
+    std::size_t header_size {0}; // bytes
+    std::vector<std::string> properties; // vertex properties in file order
+
+    bool has_property(const std::string& name) const
+    {
+        return std::find(properties.begin(), properties.end(), name) != properties.end();
+    }
 
-    std::filebuf file;
-    file.open(filename + ".ply", is_binary ? (std::ios::out | std::ios::binary) : std::ios::out);
+    // Rough parsing throughput of read_ply(...) in MB/s
+    static constexpr double binary_throughput_mbps = 500.;
+    static constexpr double ascii_throughput_mbps = 50.;
 
-    std::ostream outstream(&file);
-    if (outstream.fail()) throw std::runtime_error("failed to open " + filename);
+    double estimated_load_time() const // seconds
+    {
+        const double payload_mb = static_cast<double>(file_size - std::min(file_size, header_size)) * 1e-6;
+        return payload_mb / (is_binary ? binary_throughput_mbps : ascii_throughput_mbps);
+    }
 
-    ply_file.write(outstream, is_binary); // ASCII, is_binary = false
+    std::size_t estimated_memory() const // bytes of VertexData after loading
+    {
+        std::size_t per_vertex = sizeof(QVector3D);
+        if (has_property("red") || has_property("r")) per_vertex += sizeof(QVector4D);
+        if (has_property("nx")) per_vertex += sizeof(QVector3D);
+        if (has_property("u")) per_vertex += sizeof(QVector2D);
+        return vertex_count * per_vertex;
+    }
+};
+
+/*!
+ * \brief probe_ply
+ * Reads only the header of the file, the payload is never touched.
+ * \param file_name
+ * \return metadata, PlyInfo::valid is false if the header could not be parsed
+ */
+inline PlyInfo probe_ply(const std::string& file_name)
+{
+    PlyInfo info;
+    info.file_name = file_name;
+
+    try
+    {
+        std::ifstream file_stream(file_name, std::ios::binary);
+        if (file_stream.fail()) return info;
+
+        file_stream.seekg(0, std::ios::end);
+        info.file_size = static_cast<std::size_t>(file_stream.tellg());
+        file_stream.seekg(0, std::ios::beg);
+
+        tinyply::PlyFile file;
+        if (!file.parse_header(file_stream)) return info;
+        info.header_size = static_cast<std::size_t>(file_stream.tellg());
+        info.is_binary = file.is_binary_file();
+        info.is_big_endian = file.is_big_endian_file();
+
+        for (const auto & e : file.get_elements())
+        {
+            if (e.name != "vertex") continue;
+            info.vertex_count = e.size;
+            for (const auto & p : e.properties) info.properties.emplace_back(p.name);
+            info.valid = true;
+        }
+    }
+    catch (const std::exception & e)
+    {
+        std::cerr << "probe_ply " << file_name << ": " << e.what() << std::endl;
+    }
+
+    return info;
 }
 
 inline VertexData read_ply(const std::string& file_name, const bool preload_into_memory = true)
@@ -143,7 +287,9 @@ inline VertexData read_ply(const std::string& file_name, const bool preload_into
         for (const auto & c : file.get_comments()) std::cout << "\t[ply_header] Comment: " << c << std::endl;
         for (const auto & c : file.get_info()) std::cout << "\t[ply_header] Info: " << c << std::endl;
 
-        for (const auto & e : file.get_elements())
+        const std::vector<tinyply::PlyElement> elements = file.get_elements();
+        const tinyply::PlyElement* vertex_element = nullptr;
+        for (const auto & e : elements)
         {
             std::cout << "\t[ply_header] element: " << e.name << " (" << e.size << ")" << std::endl;
             for (const auto & p : e.properties)
@@ -151,41 +297,47 @@ inline VertexData read_ply(const std::string& file_name, const bool preload_into
                 std::cout << "\t[ply_header] \tproperty: " << p.name << " (type=" << tinyply::PropertyTable[p.propertyType].str << ")";
                 if (p.isList) std::cout << " (list_type=" << tinyply::PropertyTable[p.listType].str << ")";
                 std::cout << std::endl;
-                has_alpha = p.name=="alpha" || p.name=="a";
+
+                // Every other scalar vertex property becomes a typed column, decoded only when selected
+                if (e.name == "vertex" && !p.isList && !is_standard_vertex_property(p.name)) {
+                    PointAttribute attribute;
+                    attribute.name = p.name;
+                    attribute.type = p.propertyType;
+                    vertex_data.attributes.emplace_back(attribute);
+                }
             }
+            if (e.name == "vertex")
+                vertex_element = &e;
         }
 
-        // Because most people have their own mesh types, tinyply treats parsed data as structured/typed byte buffers.
-        // See examples below on how to marry your own application-specific data structures with this one.
-        std::shared_ptr<tinyply::PlyData> vertices, normals, colors, texcoords, faces, tripstrip;
-
-        // The header information can be used to programmatically extract properties on elements
-        // known to exist in the header prior to reading the data. For brevity of this sample, properties
-        // like vertex position are hard-coded:
-        try { vertices = file.request_properties_from_element("vertex", { "x", "y", "z" }); }
-        catch (const std::exception & e) { std::cerr << "tinyply exception: " << e.what() << std::endl; }
-
-        try { normals = file.request_properties_from_element("vertex", { "nx", "ny", "nz" }); }
-        catch (const std::exception & e) { std::cerr << "tinyply exception: " << e.what() << std::endl; }
-
-        try { colors = file.request_properties_from_element("vertex", { "red", "green", "blue", "alpha" }); }
-        catch (const std::exception & e) { std::cerr << "tinyply exception: " << e.what() << std::endl; }
+        if (nullptr == vertex_element) throw std::runtime_error("no vertex element in " + file_name);
 
-        try { colors = file.request_properties_from_element("vertex", { "r", "g", "b", "a" }); }
-        catch (const std::exception & e) { std::cerr << "tinyply exception: " << e.what() << std::endl; }
-
-        try { texcoords = file.request_properties_from_element("vertex", { "u", "v" }); }
-        catch (const std::exception & e) { std::cerr << "tinyply exception: " << e.what() << std::endl; }
-
-        // Providing a list size hint (the last argument) is a 2x performance improvement. If you have
-        // arbitrary ply files, it is best to leave this 0.
-        try { faces = file.request_properties_from_element("face", { "vertex_indices" }, 3); }
-        catch (const std::exception & e) { std::cerr << "tinyply exception: " << e.what() << std::endl; }
-
-        // Tristrips must always be read with a 0 list size hint (unless you know exactly how many elements
-        // are specifically in the file, which is unlikely);
-        try { tripstrip = file.request_properties_from_element("tristrips", { "vertex_indices" }, 0); }
-        catch (const std::exception & e) { std::cerr << "tinyply exception: " << e.what() << std::endl; }
+        // Because most people have their own mesh types, tinyply treats parsed data as structured/typed byte buffers.
+        std::shared_ptr<tinyply::PlyData> vertices, normals, colors, texcoords;
+
+        // Only properties present in the header are requested, so the happy path throws nothing. Faces,
+        // tristrips and any other element are not requested at all and the parser skips them in bulk.
+        // A non-zero size hint on scalar properties lets tinyply allocate up front and parse in a single pass.
+        auto request = [&file, vertex_element](const std::vector<std::string>& names) -> std::shared_ptr<tinyply::PlyData> {
+            if (!has_ply_properties(*vertex_element, names))
+                return nullptr;
+            return file.request_properties_from_element("vertex", names, 1);
+        };
+
+        vertices = request({ "x", "y", "z" });
+        normals = request({ "nx", "ny", "nz" });
+        texcoords = request({ "u", "v" });
+
+        for (const auto& names : std::vector<std::vector<std::string>>{{ "red", "green", "blue", "alpha" },
+                                                                      { "red", "green", "blue" },
+                                                                      { "r", "g", "b", "a" },
+                                                                      { "r", "g", "b" }}) {
+            colors = request(names);
+            if (colors) {
+                has_alpha = names.size() == 4;
+                break;
+            }
+        }
 
         manual_timer read_timer;
 
@@ -204,6 +356,8 @@ inline VertexData read_ply(const std::string& file_name, const bool preload_into
         if (colors) {
             std::cerr << "\tRead " << colors->count << " total vertex colors " << std::endl;
             std::cerr << "\thas_alpha= " << has_alpha << std::endl;
+            vertex_data.color_type = colors->t;
+            vertex_data.has_alpha = has_alpha;
 
             if (colors->t == tinyply::Type::UINT8) {
                 vertex_data.colors.reserve(colors->count);
@@ -224,8 +378,12 @@ inline VertexData read_ply(const std::string& file_name, const bool preload_into
                 }
             }
             else if (colors->t == tinyply::Type::FLOAT32) {
-                vertex_data.colors.resize(colors->count);
-                std::memcpy(vertex_data.colors.data(), vertices->buffer.get(), vertices->buffer.size_bytes());
+                const float* src = reinterpret_cast<const float*>(colors->buffer.get_const());
+                const std::size_t channels = has_alpha ? 4 : 3;
+                vertex_data.colors.reserve(colors->count);
+                for (std::size_t i=0; i<colors->count*channels; i+=channels) {
+                    vertex_data.colors.emplace_back(src[i], src[i+1], src[i+2], has_alpha ? src[i+3] : 1.F);
+                }
             }
         }
         if (normals) {
@@ -0,0 +1,232 @@
+#ifndef PLYTAIL_H
+#define PLYTAIL_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+#include <opengl_helper.hpp>
+
+#include <tinyply.h>
+
+namespace graphics {
+
+/*!
+ * \brief The PlyTailReader class
+ * Follows a binary PLY file that is being appended to (e.g. by a capture rig) and decodes
+ * only the vertex records written since the last poll. The vertex count of the header is
+ * ignored, the number of complete records is derived from the file size; a record that is
+ * only partially written is picked up by the next poll.
+ */
+class PlyTailReader
+{
+public:
+    static constexpr std::size_t default_max_records = 1 << 20; // per poll, keeps a frame short
+
+    bool open(const std::string& file_name, const std::size_t records_read);
+    std::size_t poll(VertexData& appended, const std::size_t max_records = default_max_records);
+
+    bool is_open() const { return m_stride > 0; }
+    bool has_colors() const { return !m_color.empty(); }
+    bool has_normals() const { return m_has_normals; }
+    std::size_t records_read() const { return m_records_read; }
+    const std::string& file_name() const { return m_file_name; }
+
+private:
+    struct Field
+    {
+        std::size_t offset {0}; // bytes from the start of the record
+        tinyply::Type type {tinyply::Type::INVALID};
+    };
+
+    std::string m_file_name;
+    std::ifstream m_file;
+    std::size_t m_data_start {0}; // first byte of the vertex records
+    std::size_t m_stride {0};     // bytes per vertex record
+    std::size_t m_records_read {0};
+    Field m_xyz[3];
+    std::vector<Field> m_color;
+    Field m_normal[3];
+    bool m_has_normals {false};
+    std::vector<char> m_buffer;
+};
+
+/*!
+ * \brief PlyTailReader::open
+ * \param file_name binary little endian PLY with the vertex element last
+ * \param records_read vertex records already loaded, the first poll starts after them
+ * \return false if the file can not be followed
+ */
+inline bool
+PlyTailReader::open(const std::string& file_name, const std::size_t records_read)
+{
+    m_stride = 0;
+    m_color.clear();
+    m_has_normals = false;
+    m_file_name = file_name;
+    m_file.close();
+    m_file.open(file_name, std::ios::binary);
+    if (m_file.fail())
+        return false;
+
+    try
+    {
+        tinyply::PlyFile file;
+        if (!file.parse_header(m_file))
+            return false;
+
+        if (!file.is_binary_file() || file.is_big_endian_file()) {
+            std::cerr << "PlyTailReader: " << file_name << " is not binary little endian, it can not be followed" << std::endl;
+            return false;
+        }
+        m_data_start = static_cast<std::size_t>(m_file.tellg());
+
+        const std::vector<tinyply::PlyElement> elements = file.get_elements();
+        const tinyply::PlyElement* vertex_element = nullptr;
+        for (const auto& e : elements) {
+            if (e.name == "vertex") {
+                vertex_element = &e;
+                continue;
+            }
+
+            // Records are appended at the end of the file, the vertex element has to be the last one with data
+            if (nullptr != vertex_element && e.size > 0) {
+                std::cerr << "PlyTailReader: element " << e.name << " follows the vertex element" << std::endl;
+                return false;
+            }
+            for (const auto& p : e.properties) {
+                if (p.isList && e.size > 0) {
+                    std::cerr << "PlyTailReader: element " << e.name << " has lists, the vertex offset is unknown" << std::endl;
+                    return false;
+                }
+                m_data_start += e.size * static_cast<std::size_t>(tinyply::PropertyTable[p.propertyType].stride);
+            }
+        }
+
+        if (nullptr == vertex_element)
+            return false;
+
+        std::vector<std::pair<std::string, Field>> fields;
+        std::size_t offset = 0;
+        for (const auto& p : vertex_element->properties) {
+            if (p.isList) {
+                std::cerr << "PlyTailReader: vertex property " << p.name << " is a list" << std::endl;
+                return false;
+            }
+            fields.push_back({p.name, {offset, p.propertyType}});
+            offset += static_cast<std::size_t>(tinyply::PropertyTable[p.propertyType].stride);
+        }
+
+        auto find = [&fields](const std::string& name, Field& field) {
+            for (const auto& f : fields) {
+                if (f.first == name) {
+                    field = f.second;
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        if (!find("x", m_xyz[0]) || !find("y", m_xyz[1]) || !find("z", m_xyz[2]))
+            return false;
+
+        for (const auto& names : std::vector<std::vector<std::string>>{{ "red", "green", "blue", "alpha" },
+                                                                      { "red", "green", "blue" },
+                                                                      { "r", "g", "b", "a" },
+                                                                      { "r", "g", "b" }}) {
+            std::vector<Field> color(names.size());
+            bool found = true;
+            for (std::size_t i=0; i<names.size() && found; i++)
+                found = find(names[i], color[i]);
+            if (found) {
+                m_color = color;
+                break;
+            }
+        }
+
+        m_has_normals = find("nx", m_normal[0]) && find("ny", m_normal[1]) && find("nz", m_normal[2]);
+
+        m_records_read = records_read;
+        m_stride = offset;
+    }
+    catch (const std::exception & e)
+    {
+        std::cerr << "PlyTailReader: " << e.what() << std::endl;
+        return false;
+    }
+
+    std::cout << "Following " << file_name << " from record " << m_records_read << std::endl;
+    return true;
+}
+
+/*!
+ * \brief PlyTailReader::poll
+ * Appends the records written since the last poll to the vertex data: positions, and colors and
+ * normals when the file has them. The other vertex properties are not read.
+ * \return number of new records
+ */
+inline std::size_t
+PlyTailReader::poll(VertexData& appended, const std::size_t max_records)
+{
+    if (!is_open())
+        return 0;
+
+    std::error_code ec;
+    const std::size_t file_size = static_cast<std::size_t>(std::filesystem::file_size(m_file_name, ec));
+    if (ec || file_size < m_data_start)
+        return 0;
+
+    const std::size_t available = (file_size - m_data_start) / m_stride;
+    if (available < m_records_read) {
+        std::cerr << "PlyTailReader: " << m_file_name << " was truncated" << std::endl;
+        m_records_read = available;
+        return 0;
+    }
+
+    const std::size_t count = std::min(available - m_records_read, max_records);
+    if (0 == count)
+        return 0;
+
+    // Only the new complete records are read, the stream may have hit the old end of file before
+    m_buffer.resize(count * m_stride);
+    m_file.clear();
+    m_file.seekg(static_cast<std::streamoff>(m_data_start + m_records_read * m_stride));
+    m_file.read(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+    if (static_cast<std::size_t>(m_file.gcount()) != m_buffer.size())
+        return 0;
+
+    const bool color_is_uchar = has_colors() && tinyply::Type::UINT8 == m_color[0].type;
+    const float color_scale = color_is_uchar ? 1.F / 255.F : 1.F;
+
+    appended.positions.reserve(appended.positions.size() + count);
+    if (has_colors())
+        appended.colors.reserve(appended.colors.size() + count);
+    if (has_normals())
+        appended.normals.reserve(appended.normals.size() + count);
+
+    for (std::size_t i=0; i<count; i++) {
+        const std::uint8_t* record = reinterpret_cast<const std::uint8_t*>(m_buffer.data()) + i * m_stride;
+        appended.positions.emplace_back(read_ply_value(m_xyz[0].type, record + m_xyz[0].offset),
+                                        read_ply_value(m_xyz[1].type, record + m_xyz[1].offset),
+                                        read_ply_value(m_xyz[2].type, record + m_xyz[2].offset));
+        if (has_colors()) {
+            float c[4] = {0.F, 0.F, 0.F, 1.F / color_scale};
+            for (std::size_t k=0; k<m_color.size(); k++)
+                c[k] = read_ply_value(m_color[k].type, record + m_color[k].offset);
+            appended.colors.emplace_back(c[0] * color_scale, c[1] * color_scale, c[2] * color_scale, c[3] * color_scale);
+        }
+        if (has_normals())
+            appended.normals.emplace_back(read_ply_value(m_normal[0].type, record + m_normal[0].offset),
+                                          read_ply_value(m_normal[1].type, record + m_normal[1].offset),
+                                          read_ply_value(m_normal[2].type, record + m_normal[2].offset));
+    }
+
+    m_records_read += count;
+    return count;
+}
+
+}
+
+#endif // PLYTAIL_H
@@ -0,0 +1,259 @@
+#ifndef PLYWRITER_H
+#define PLYWRITER_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <charconv>
+#include <future>
+#include <algorithm>
+
+#include <opengl_helper.hpp>
+#include <plyloader.h>
+#include <parallel.hpp>
+
+#include <tinyply.h>
+
+namespace graphics {
+
+/*!
+ * \brief The PlyColumn struct
+ * One scalar vertex property as it is written: a strided view into the source vector.
+ * Colours loaded from uchar are stored as [0,1] floats and quantized back on the way out.
+ */
+struct PlyColumn
+{
+    std::string name;
+    tinyply::Type type {tinyply::Type::INVALID}; // type in the written file
+    std::size_t bytes {0};                       // size of one value in the written file
+    const std::uint8_t* data {nullptr};
+    std::size_t stride {0};                      // bytes between two vertices in the source
+    bool unit_float_to_uchar {false};
+};
+
+/*!
+ * \brief make_ply_columns
+ * Only the properties present in the vertex data are written, in their source types.
+ * Attribute columns are written if they have been loaded.
+ */
+inline std::vector<PlyColumn> make_ply_columns(const VertexData& vertex_data)
+{
+    std::vector<PlyColumn> columns;
+    const std::size_t count = vertex_data.positions.size();
+
+    auto add = [&columns](const std::string& name, const tinyply::Type type, const void* data,
+                          const std::size_t stride, const bool unit_float_to_uchar = false) {
+        PlyColumn c;
+        c.name = name;
+        c.type = type;
+        c.bytes = static_cast<std::size_t>(tinyply::PropertyTable[type].stride);
+        c.data = static_cast<const std::uint8_t*>(data);
+        c.stride = stride;
+        c.unit_float_to_uchar = unit_float_to_uchar;
+        columns.emplace_back(c);
+    };
+
+    const std::vector<std::string> xyz = { "x", "y", "z" };
+    for (std::size_t i=0; i<3; i++)
+        add(xyz[i], tinyply::Type::FLOAT32, reinterpret_cast<const float*>(vertex_data.positions.data()) + i, sizeof(QVector3D));
+
+    if (count > 0 && vertex_data.normals.size() == count) {
+        const std::vector<std::string> names = { "nx", "ny", "nz" };
+        for (std::size_t i=0; i<3; i++)
+            add(names[i], tinyply::Type::FLOAT32, reinterpret_cast<const float*>(vertex_data.normals.data()) + i, sizeof(QVector3D));
+    }
+
+    if (count > 0 && vertex_data.colors.size() == count) {
+        const bool as_uchar = tinyply::Type::UINT8 == vertex_data.color_type;
+        const std::vector<std::string> names = { "red", "green", "blue", "alpha" };
+        const std::size_t channels = vertex_data.has_alpha ? 4 : 3;
+        for (std::size_t i=0; i<channels; i++)
+            add(names[i], as_uchar ? tinyply::Type::UINT8 : tinyply::Type::FLOAT32,
+                reinterpret_cast<const float*>(vertex_data.colors.data()) + i, sizeof(QVector4D), as_uchar);
+    }
+
+    if (count > 0 && vertex_data.tex_coords.size() == count) {
+        const std::vector<std::string> names = { "u", "v" };
+        for (std::size_t i=0; i<2; i++)
+            add(names[i], tinyply::Type::FLOAT32, reinterpret_cast<const float*>(vertex_data.tex_coords.data()) + i, sizeof(QVector2D));
+    }
+
+    for (const auto& attribute : vertex_data.attributes) {
+        if (attribute.is_loaded() && attribute.size() == count)
+            add(attribute.name, attribute.type, attribute.data.data(), attribute.stride());
+    }
+
+    return columns;
+}
+
+inline std::uint8_t quantize_unit_float(const std::uint8_t* src)
+{
+    float v;
+    std::memcpy(&v, src, sizeof(float));
+    return static_cast<std::uint8_t>(std::clamp(v, 0.F, 1.F) * 255.F + .5F);
+}
+
+inline char* pack_ply_row_binary(const std::vector<PlyColumn>& columns, const std::size_t idx, char* dst)
+{
+    for (const auto& c : columns) {
+        const std::uint8_t* src = c.data + idx * c.stride;
+        if (c.unit_float_to_uchar)
+            *dst = static_cast<char>(quantize_unit_float(src));
+        else
+            std::memcpy(dst, src, c.bytes);
+        dst += c.bytes;
+    }
+    return dst;
+}
+
+template <typename T, typename Cast = T>
+inline char* format_ply_value(const std::uint8_t* src, char* first, char* last)
+{
+    T v;
+    std::memcpy(&v, src, sizeof(T));
+    return std::to_chars(first, last, static_cast<Cast>(v)).ptr;
+}
+
+inline char* pack_ply_row_ascii(const std::vector<PlyColumn>& columns, const std::size_t idx, char* dst, char* last)
+{
+    for (const auto& c : columns) {
+        const std::uint8_t* src = c.data + idx * c.stride;
+        if (c.unit_float_to_uchar) {
+            dst = std::to_chars(dst, last, static_cast<int>(quantize_unit_float(src))).ptr;
+        } else {
+            switch (c.type) {
+            case tinyply::Type::INT8:    dst = format_ply_value<std::int8_t, int>(src, dst, last); break;
+            case tinyply::Type::UINT8:   dst = format_ply_value<std::uint8_t, int>(src, dst, last); break;
+            case tinyply::Type::INT16:   dst = format_ply_value<std::int16_t>(src, dst, last); break;
+            case tinyply::Type::UINT16:  dst = format_ply_value<std::uint16_t>(src, dst, last); break;
+            case tinyply::Type::INT32:   dst = format_ply_value<std::int32_t>(src, dst, last); break;
+            case tinyply::Type::UINT32:  dst = format_ply_value<std::uint32_t>(src, dst, last); break;
+            case tinyply::Type::FLOAT32: dst = format_ply_value<float>(src, dst, last); break;
+            case tinyply::Type::FLOAT64: dst = format_ply_value<double>(src, dst, last); break;
+            case tinyply::Type::INVALID: break;
+            }
+        }
+        *dst++ = ' ';
+    }
+    *(dst - 1) = '\n'; // replaces the last separator
+    return dst;
+}
+
+/*!
+ * \brief write_ply
+ * Streams the vertex data to a PLY file without an intermediate copy of the whole cloud.
+ * Rows are packed block by block on all cores (ASCII formatted with std::to_chars) while
+ * the previous block is being written, blocks go to the file unbuffered.
+ * Binary files are written little endian.
+ * \param file_name full path, nothing is appended
+ * \param vertex_data
+ * \param is_binary
+ * \return true if the whole file was written
+ */
+inline bool write_ply(const std::string& file_name, const VertexData& vertex_data, const bool is_binary = true)
+{
+    constexpr std::size_t block_size = 16 << 20;         // bytes per write
+    constexpr std::size_t ascii_chars_per_value = 32;   // enough for the shortest round-trip double
+    constexpr std::size_t ascii_chunk_rows = 4096;      // rows formatted by one task
+
+    manual_timer write_timer;
+    write_timer.start();
+
+    const std::vector<PlyColumn> columns = make_ply_columns(vertex_data);
+    const std::size_t count = vertex_data.positions.size();
+
+    std::size_t row_size = 0;
+    for (const auto& c : columns)
+        row_size += is_binary ? c.bytes : ascii_chars_per_value;
+    const std::size_t rows_per_block = std::max<std::size_t>(1, block_size / row_size);
+
+    std::ostringstream header;
+    header << "ply\n"
+           << "format " << (is_binary ? "binary_little_endian" : "ascii") << " 1.0\n"
+           << "comment qt-pc-viewer\n"
+           << "element vertex " << count << "\n";
+    for (const auto& c : columns)
+        header << "property " << tinyply::PropertyTable[c.type].str << " " << c.name << "\n";
+    header << "end_header\n";
+
+    // The stream buffer would only copy the blocks once more, it has to be disabled before open()
+    std::ofstream file;
+    file.rdbuf()->pubsetbuf(nullptr, 0);
+    file.open(file_name, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "write_ply: failed to open " << file_name << std::endl;
+        return false;
+    }
+
+    const std::string header_text = header.str();
+    file.write(header_text.data(), static_cast<std::streamsize>(header_text.size()));
+
+    // Two blocks: one is packed while the other one is written
+    std::vector<char> blocks[2];
+    std::future<void> pending_write;
+    std::size_t block_index = 0;
+
+    for (std::size_t block_begin = 0; block_begin < count; block_begin += rows_per_block) {
+        const std::size_t block_end = std::min(count, block_begin + rows_per_block);
+        const std::size_t rows = block_end - block_begin;
+        std::vector<char>& block = blocks[block_index++ % 2];
+        block.resize(rows * row_size);
+
+        if (is_binary) {
+            parallel_for(0, rows, [&](const std::size_t begin, const std::size_t end) {
+                char* dst = block.data() + begin * row_size;
+                for (std::size_t i=begin; i<end; i++)
+                    dst = pack_ply_row_binary(columns, block_begin + i, dst);
+            });
+        } else {
+            // Every chunk is formatted into its own worst-case sized slot, slots are compacted in order
+            const std::size_t chunks_count = (rows + ascii_chunk_rows - 1) / ascii_chunk_rows;
+            std::vector<std::size_t> chunk_length(chunks_count, 0);
+            parallel_for(0, chunks_count, 1, [&](const std::size_t begin, const std::size_t end) {
+                for (std::size_t c=begin; c<end; c++) {
+                    char* first = block.data() + c * ascii_chunk_rows * row_size;
+                    char* last = first + std::min(ascii_chunk_rows, rows - c * ascii_chunk_rows) * row_size;
+                    char* dst = first;
+                    for (std::size_t i = c * ascii_chunk_rows; i < std::min(rows, (c + 1) * ascii_chunk_rows); i++)
+                        dst = pack_ply_row_ascii(columns, block_begin + i, dst, last);
+                    chunk_length[c] = static_cast<std::size_t>(dst - first);
+                }
+            });
+
+            std::size_t used = 0;
+            for (std::size_t c=0; c<chunks_count; c++) {
+                std::memmove(block.data() + used, block.data() + c * ascii_chunk_rows * row_size, chunk_length[c]);
+                used += chunk_length[c];
+            }
+            block.resize(used);
+        }
+
+        if (pending_write.valid())
+            pending_write.get();
+        pending_write = std::async(std::launch::async, [&file, &block]() {
+            file.write(block.data(), static_cast<std::streamsize>(block.size()));
+        });
+    }
+
+    if (pending_write.valid())
+        pending_write.get();
+    file.close();
+
+    write_timer.stop();
+
+    if (file.fail()) {
+        std::cerr << "write_ply: failed to write " << file_name << std::endl;
+        return false;
+    }
+
+    std::cout << "Wrote " << count << " vertices (" << columns.size() << " properties) to " << file_name
+              << " in " << write_timer.get() << " ms" << std::endl;
+    return true;
+}
+
+}
+
+#endif // PLYWRITER_H
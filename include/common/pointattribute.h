@@ -0,0 +1,91 @@
+#ifndef POINTATTRIBUTE_H
+#define POINTATTRIBUTE_H
+
+#include <string>
+#include <vector>
+#include <tuple>
+#include <limits>
+#include <cstring>
+#include <cstdint>
+
+#include <tinyply.h>
+
+namespace graphics {
+
+/*!
+ * \brief The PointAttribute struct
+ * Typed per-vertex column of the PLY file (e.g. intensity, classification, scalar_*).
+ * The loader fills only the descriptor (name and type) from the header, the values
+ * are decoded on demand and kept in the source type.
+ */
+struct PointAttribute
+{
+    std::string name;
+    tinyply::Type type {tinyply::Type::INVALID};
+    std::vector<std::uint8_t> data; // raw values in the source type, empty until loaded
+
+    bool is_loaded() const { return !data.empty(); }
+    std::size_t stride() const { return static_cast<std::size_t>(tinyply::PropertyTable[type].stride); }
+    std::size_t size() const { return stride() > 0 ? data.size() / stride() : 0; }
+
+    float value(const std::size_t idx) const;
+    std::tuple<float, float> find_min_max() const;
+};
+
+template <typename T>
+inline float
+read_attribute_value(const std::uint8_t* ptr)
+{
+    T v;
+    std::memcpy(&v, ptr, sizeof(T));
+    return static_cast<float>(v);
+}
+
+/*!
+ * \brief read_ply_value
+ * \return the value of a PLY scalar of the given type, converted to float
+ */
+inline float
+read_ply_value(const tinyply::Type type, const std::uint8_t* ptr)
+{
+    switch (type) {
+    case tinyply::Type::INT8:    return read_attribute_value<std::int8_t>(ptr);
+    case tinyply::Type::UINT8:   return read_attribute_value<std::uint8_t>(ptr);
+    case tinyply::Type::INT16:   return read_attribute_value<std::int16_t>(ptr);
+    case tinyply::Type::UINT16:  return read_attribute_value<std::uint16_t>(ptr);
+    case tinyply::Type::INT32:   return read_attribute_value<std::int32_t>(ptr);
+    case tinyply::Type::UINT32:  return read_attribute_value<std::uint32_t>(ptr);
+    case tinyply::Type::FLOAT32: return read_attribute_value<float>(ptr);
+    case tinyply::Type::FLOAT64: return read_attribute_value<double>(ptr);
+    case tinyply::Type::INVALID: break;
+    }
+    return 0.F;
+}
+
+inline float
+PointAttribute::value(const std::size_t idx) const
+{
+    return read_ply_value(type, data.data() + idx * stride());
+}
+
+inline std::tuple<float, float>
+PointAttribute::find_min_max() const
+{
+    float min = std::numeric_limits<float>::max();
+    float max = std::numeric_limits<float>::lowest();
+
+    const std::size_t count = size();
+    for (std::size_t i=0; i<count; i++) {
+        const float v = value(i);
+        if (v < min) min = v;
+        if (v > max) max = v;
+    }
+
+    if (min > max)
+        return {0.F, 0.F};
+    return {min, max};
+}
+
+}
+
+#endif // POINTATTRIBUTE_H
@@ -7,6 +7,7 @@
 #include <QFormLayout>
 #include <QGroupBox>
 #include <QIntValidator>
+#include <QDoubleValidator>
 #include <QSlider>
 #include <QComboBox>
 #include <QCheckBox>
@@ -30,7 +31,7 @@ public:
         setWindowModality(Qt::NonModal);
 
         constexpr int window_width = 350;
-        constexpr int window_height = 400;
+        constexpr int window_height = 565;
         resize(window_width, window_height);
         QSizePolicy sizePolicy(QSizePolicy::Preferred, QSizePolicy::Preferred);
         setSizePolicy(sizePolicy);
@@ -43,6 +44,7 @@ public:
         connect(m_rgb_original_box, &QGroupBox::clicked, this, &PointControlDialog::slot_process_universal_checkbox);
         connect(m_rgb_encoding_box,  &QGroupBox::clicked, this, &PointControlDialog::slot_process_universal_checkbox);
         connect(m_lut_cbx, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &PointControlDialog::slot_process_combo_box_changed);
+        connect(m_color_source_cbx, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &PointControlDialog::slot_process_combo_box_changed);
         connect(m_lut_inversion_chbx, &QCheckBox::stateChanged, this, &PointControlDialog::slot_process_universal_checkbox);
         connect(m_point_size_sld, &QSlider::valueChanged, this, &PointControlDialog::slot_process_universal_slider_value_changed);
 
@@ -53,12 +55,16 @@ public:
     {
         m_positioning_widget = create_positioning_widget();
         m_point_size_widget = create_point_size_widget();
+        m_voxel_widget = create_voxel_widget();
+        m_outlier_box = create_outlier_control_box();
         m_rgb_original_box = create_rgb_original_control_box(); // needs the member of the class to live after scope
         m_rgb_encoding_box = create_rgb_encoding_control_box(); // needs the member of the class to live after scope
 
         QVBoxLayout *vertical_layout = new QVBoxLayout;
         vertical_layout->addWidget(m_positioning_widget);
         vertical_layout->addWidget(m_point_size_widget);
+        vertical_layout->addWidget(m_voxel_widget);
+        vertical_layout->addWidget(m_outlier_box);
         vertical_layout->addWidget(m_rgb_original_box);
         vertical_layout->addWidget(m_rgb_encoding_box);
         vertical_layout->addStretch();
@@ -70,16 +76,31 @@ public:
 
     QWidget* create_positioning_widget();
     QWidget* create_point_size_widget();
+    QWidget* create_voxel_widget();
+    QGroupBox* create_outlier_control_box();
+    void apply_outlier_filter();
     QGroupBox* create_rgb_original_control_box();
     QGroupBox* create_rgb_encoding_control_box();
+    void refresh_attribute_list();
 
     QGroupBox *m_rgb_original_box {nullptr};
     QGroupBox *m_rgb_encoding_box {nullptr};
     QComboBox* m_lut_cbx {nullptr};
+    QComboBox* m_color_source_cbx {nullptr};
     QCheckBox* m_lut_inversion_chbx {nullptr};
     QWidget* m_point_size_widget {nullptr};
     QLabel* m_point_size_lbl {nullptr};
     QSlider* m_point_size_sld {nullptr};
+    QCheckBox* m_shading_chbx {nullptr};
+    QCheckBox* m_size_attenuation_chbx {nullptr};
+    QCheckBox* m_edl_chbx {nullptr};
+    QCheckBox* m_adaptive_resolution_chbx {nullptr};
+    QCheckBox* m_frame_governor_chbx {nullptr};
+    QWidget* m_voxel_widget {nullptr};
+    QLineEdit* m_voxel_size_ledit {nullptr};
+    QGroupBox* m_outlier_box {nullptr};
+    QLineEdit* m_outlier_k_ledit {nullptr};
+    QLineEdit* m_outlier_sigma_ledit {nullptr};
 
     QWidget* m_positioning_widget {nullptr};
     QCheckBox* m_x_inversion_chbx {nullptr};
@@ -225,14 +246,107 @@ QWidget* PointControlDialog::create_point_size_widget()
     m_point_size_sld->setTickInterval(1);
     m_point_size_sld->setValue(static_cast<int>(m_viewer_window->m_pointcloud_object->m_point_size));
 
+    m_shading_chbx = new QCheckBox("Shading");
+    m_shading_chbx->setChecked(m_viewer_window->m_pointcloud_object->m_shading);
+    m_shading_chbx->setToolTip("Lights the points from their normals, estimated when the file has none");
+    m_size_attenuation_chbx = new QCheckBox("Perspective size");
+    m_size_attenuation_chbx->setChecked(m_viewer_window->m_pointcloud_object->m_size_attenuation);
+    m_size_attenuation_chbx->setToolTip("Points at the center of rotation have the point size, closer ones are larger");
+    connect(m_shading_chbx, &QCheckBox::stateChanged, this, &PointControlDialog::slot_process_universal_checkbox);
+    connect(m_size_attenuation_chbx, &QCheckBox::stateChanged, this, &PointControlDialog::slot_process_universal_checkbox);
+    m_edl_chbx = new QCheckBox("Eye-dome lighting");
+    m_edl_chbx->setChecked(m_viewer_window->m_eye_dome_lighting);
+    m_edl_chbx->setToolTip("Outlines the shape from the depth of the drawn points, without normals");
+    connect(m_edl_chbx, &QCheckBox::stateChanged, this, &PointControlDialog::slot_process_universal_checkbox);
+    m_adaptive_resolution_chbx = new QCheckBox("Adaptive resolution");
+    m_adaptive_resolution_chbx->setChecked(m_viewer_window->m_adaptive_resolution);
+    m_adaptive_resolution_chbx->setToolTip("Draws the points at a lower resolution while the view moves to keep 60 FPS");
+    connect(m_adaptive_resolution_chbx, &QCheckBox::stateChanged, this, &PointControlDialog::slot_process_universal_checkbox);
+    m_frame_governor_chbx = new QCheckBox("Hold 60 FPS");
+    m_frame_governor_chbx->setChecked(m_viewer_window->m_frame_governor_enabled);
+    m_frame_governor_chbx->setToolTip("Lowers multisampling, resolution, then the number of drawn points until a frame takes 16.6 ms");
+    connect(m_frame_governor_chbx, &QCheckBox::stateChanged, this, &PointControlDialog::slot_process_universal_checkbox);
+
+    QHBoxLayout *hlayout_pass = new QHBoxLayout;
+    hlayout_pass->addWidget(m_edl_chbx);
+    hlayout_pass->addWidget(m_adaptive_resolution_chbx);
+    hlayout_pass->addWidget(m_frame_governor_chbx);
+
+    QHBoxLayout *hlayout_style = new QHBoxLayout;
+    hlayout_style->addWidget(m_shading_chbx);
+    hlayout_style->addWidget(m_size_attenuation_chbx);
+
     QFormLayout *form_layout = new QFormLayout;
     form_layout->addRow(m_point_size_lbl);
     form_layout->addRow(m_point_size_sld);
+    form_layout->addRow(hlayout_style);
+    form_layout->addRow(hlayout_pass);
     w->setLayout(form_layout);
 
     return w;
 }
 
+inline
+QWidget* PointControlDialog::create_voxel_widget()
+{
+    QLabel* voxel_size_lbl = new QLabel("Voxel size (0 shows all points):");
+    m_voxel_size_ledit = new QLineEdit;
+    m_voxel_size_ledit->setValidator(new QDoubleValidator(0., 1e6, 6, m_voxel_size_ledit));
+    m_voxel_size_ledit->setText(QString::number(static_cast<double>(m_viewer_window->voxel_size())));
+    m_voxel_size_ledit->setToolTip("Decimates the displayed cloud to one point per voxel, export keeps every point");
+    connect(m_voxel_size_ledit, &QLineEdit::editingFinished, this, &PointControlDialog::slot_process_universal_line_edit_finished);
+
+    QHBoxLayout *hlayout_voxel = new QHBoxLayout;
+    hlayout_voxel->addWidget(voxel_size_lbl);
+    hlayout_voxel->addWidget(m_voxel_size_ledit);
+
+    QWidget* w = new QWidget;
+    w->setLayout(hlayout_voxel);
+
+    return w;
+}
+
+inline
+QGroupBox* PointControlDialog::create_outlier_control_box()
+{
+    QGroupBox* outlier_box = new QGroupBox(tr("Outlier Removal"));
+    outlier_box->setCheckable(true);
+    outlier_box->setChecked(m_viewer_window->is_outlier_filter_enabled());
+    outlier_box->setToolTip("Hides the points whose mean distance to their k nearest neighbours is above mean + sigma * stddev, export keeps every point");
+
+    m_outlier_k_ledit = new QLineEdit;
+    m_outlier_k_ledit->setValidator(new QIntValidator(1, 256, m_outlier_k_ledit));
+    m_outlier_k_ledit->setText(QString::number(m_viewer_window->outlier_neighbours()));
+    m_outlier_sigma_ledit = new QLineEdit;
+    m_outlier_sigma_ledit->setValidator(new QDoubleValidator(0., 100., 3, m_outlier_sigma_ledit));
+    m_outlier_sigma_ledit->setText(QString::number(static_cast<double>(m_viewer_window->outlier_sigma())));
+
+    connect(outlier_box, &QGroupBox::clicked, this, &PointControlDialog::slot_process_universal_checkbox);
+    connect(m_outlier_k_ledit, &QLineEdit::editingFinished, this, &PointControlDialog::slot_process_universal_line_edit_finished);
+    connect(m_outlier_sigma_ledit, &QLineEdit::editingFinished, this, &PointControlDialog::slot_process_universal_line_edit_finished);
+
+    QHBoxLayout *hlayout_outlier = new QHBoxLayout;
+    hlayout_outlier->addWidget(new QLabel("Neighbours:"));
+    hlayout_outlier->addWidget(m_outlier_k_ledit);
+    hlayout_outlier->addWidget(new QLabel("Sigma:"));
+    hlayout_outlier->addWidget(m_outlier_sigma_ledit);
+    outlier_box->setLayout(hlayout_outlier);
+
+    return outlier_box;
+}
+
+inline
+void PointControlDialog::apply_outlier_filter()
+{
+    const std::size_t k = static_cast<std::size_t>(std::max(1, m_outlier_k_ledit->text().toInt()));
+    const float sigma = m_outlier_sigma_ledit->text().toFloat();
+    const bool enabled = m_outlier_box->isChecked();
+
+    if (enabled != m_viewer_window->is_outlier_filter_enabled() || k != m_viewer_window->outlier_neighbours()
+            || !qFuzzyCompare(1.F + sigma, 1.F + m_viewer_window->outlier_sigma()))
+        m_viewer_window->set_outlier_filter(enabled, k, sigma);
+}
+
 inline
 QGroupBox* PointControlDialog::create_rgb_original_control_box()
 {
@@ -263,14 +377,34 @@ QGroupBox* PointControlDialog::create_rgb_encoding_control_box()
     if (m_viewer_window && m_viewer_window->m_pointcloud_object)
         m_lut_cbx->setCurrentIndex(m_viewer_window->m_pointcloud_object->m_pc_encoding);
 
+    m_color_source_cbx = new QComboBox;
+    refresh_attribute_list();
+
     QFormLayout *form_layout = new QFormLayout;
     form_layout->addRow(m_lut_inversion_chbx);
     form_layout->addRow(m_lut_cbx);
+    form_layout->addRow(new QLabel("Source:"), m_color_source_cbx);
     color_box->setLayout(form_layout);
 
     return color_box;
 }
 
+inline
+void PointControlDialog::refresh_attribute_list()
+{
+    if (!m_color_source_cbx || !m_viewer_window || !m_viewer_window->m_pointcloud_object)
+        return;
+
+    QSignalBlocker blocker(m_color_source_cbx);
+    m_color_source_cbx->clear();
+    m_color_source_cbx->addItem("Depth (Z)", QString());
+    for (const auto& name : m_viewer_window->attribute_names())
+        m_color_source_cbx->addItem(QString::fromStdString(name), QString::fromStdString(name));
+
+    const int idx = m_color_source_cbx->findData(QString::fromStdString(m_viewer_window->m_pointcloud_object->m_color_attribute));
+    m_color_source_cbx->setCurrentIndex(idx < 0 ? 0 : idx);
+}
+
 inline
 void PointControlDialog::slot_process_universal_slider_value_changed()
 {
@@ -299,6 +433,13 @@ void PointControlDialog::slot_process_universal_line_edit_finished()
     if (obj == m_cam_height_ledit) {
         m_viewer_window->m_camera_height = v;
     }
+    else if (obj == m_voxel_size_ledit) {
+        if (!qFuzzyCompare(1.F + v, 1.F + m_viewer_window->voxel_size()))
+            m_viewer_window->set_voxel_size(v);
+    }
+    else if (obj == m_outlier_k_ledit || obj == m_outlier_sigma_ledit) {
+        apply_outlier_filter();
+    }
     else if (obj == m_scale_xedit) {
         pc->m_scale.setX(v);
     }
@@ -343,6 +484,18 @@ void PointControlDialog::slot_process_universal_checkbox(bool checked)
         m_rgb_original_box->setChecked(!checked);
         m_viewer_window->m_pointcloud_object->m_use_original_colors = false;
         m_viewer_window->m_update_pointcloud = true;
+    } else if (obj == m_outlier_box){
+        apply_outlier_filter();
+    } else if (obj == m_shading_chbx){
+        m_viewer_window->m_pointcloud_object->m_shading = checked;
+    } else if (obj == m_size_attenuation_chbx){
+        m_viewer_window->m_pointcloud_object->m_size_attenuation = checked;
+    } else if (obj == m_edl_chbx){
+        m_viewer_window->m_eye_dome_lighting = checked;
+    } else if (obj == m_adaptive_resolution_chbx){
+        m_viewer_window->m_adaptive_resolution = checked;
+    } else if (obj == m_frame_governor_chbx){
+        m_viewer_window->m_frame_governor_enabled = checked;
     } else if (obj == m_lut_inversion_chbx){
         m_lut_inversion_chbx->setChecked(checked);
         m_viewer_window->m_pointcloud_object->m_inverse_depth_colors = checked;
@@ -367,8 +520,13 @@ void PointControlDialog::slot_process_combo_box_changed(int v)
 {
     if (!m_viewer_window || !m_viewer_window->m_pointcloud_object)
         return;
+    const QObject* obj = sender();
 
-    if(static_cast<GLPointCloudObject::pc_encoding>(v) != m_viewer_window->m_pointcloud_object->m_pc_encoding){
+    if (obj == m_color_source_cbx) {
+        const std::string name = m_color_source_cbx->itemData(v).toString().toStdString();
+        if (!m_viewer_window->select_color_attribute(name))
+            refresh_attribute_list();
+    } else if(static_cast<GLPointCloudObject::pc_encoding>(v) != m_viewer_window->m_pointcloud_object->m_pc_encoding){
         m_viewer_window->m_pointcloud_object->m_pc_encoding = static_cast<GLPointCloudObject::pc_encoding>(v);
         m_viewer_window->m_update_pointcloud = true;
     }
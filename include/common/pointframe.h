@@ -0,0 +1,49 @@
+#ifndef POINTFRAME_H
+#define POINTFRAME_H
+
+#include <cstdint>
+#include <chrono>
+
+namespace graphics {
+
+/*!
+ * \brief Point frame stream protocol
+ * Every frame is a fixed header followed by `payload_bytes` of payload, all little endian:
+ *   positions  count * 3 float32 (x, y, z)
+ *   colors     count * 4 uint8 (r, g, b, a), only if PointFrameHeader::has_rgba8 is set
+ * The timestamp is taken by the sender from the steady clock, so the latency is only
+ * meaningful between processes on the same machine.
+ */
+struct PointFrameHeader
+{
+    static constexpr std::uint32_t frame_magic = 0x46564350; // "PCVF"
+    static constexpr std::uint32_t has_rgba8 = 1U << 0;
+    static constexpr std::uint64_t max_count = 1ULL << 27;   // frames above are rejected as corrupted
+
+    std::uint32_t magic {frame_magic};
+    std::uint32_t flags {0};
+    std::uint64_t count {0};
+    std::uint64_t timestamp_ns {0};
+    std::uint64_t payload_bytes {0};
+
+    std::uint64_t positions_bytes() const { return count * 3 * sizeof(float); }
+    std::uint64_t colors_bytes() const { return (flags & has_rgba8) ? count * 4 : 0; }
+    std::uint64_t expected_payload_bytes() const { return positions_bytes() + colors_bytes(); }
+
+    bool is_valid() const
+    {
+        return frame_magic == magic && count <= max_count && payload_bytes == expected_payload_bytes();
+    }
+};
+static_assert(sizeof(PointFrameHeader) == 32, "PointFrameHeader is sent as is");
+
+inline std::uint64_t
+point_frame_clock_ns()
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                          std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+}
+
+#endif // POINTFRAME_H
@@ -0,0 +1,265 @@
+#ifndef POINTRING_H
+#define POINTRING_H
+
+#include <iostream>
+#include <string>
+#include <atomic>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <new>
+#include <algorithm>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <pointframe.h>
+
+namespace graphics {
+
+/*!
+ * \brief Shared-memory ring of point frames (POSIX shm)
+ * One producer writes frames into fixed size slots, the consumer reads the newest published
+ * slot in place. Every slot is guarded by a seqlock: the sequence is odd while the producer
+ * writes the slot, so a reader that sees the same even sequence before and after reading
+ * knows the data was not overwritten in between.
+ *
+ * Layout: PointRingHeader in the first page, then slot_count page aligned slots of slot_stride
+ * bytes, each one made of PointRingSlot, positions (capacity * 3 float32) and colors (capacity * 4 uint8).
+ */
+struct PointRingHeader
+{
+    static constexpr std::uint32_t ring_magic = 0x47525043; // "CPRG"
+    static constexpr std::uint32_t ring_version = 1;
+
+    std::uint32_t magic {ring_magic};
+    std::uint32_t version {ring_version};
+    std::uint32_t slot_count {0};
+    std::uint32_t reserved {0};
+    std::uint64_t slot_capacity {0}; // points per slot
+    std::uint64_t slot_stride {0};   // bytes per slot
+    std::atomic<std::uint64_t> published {0}; // frames published so far, the newest is in slot (published - 1) % slot_count
+};
+
+struct PointRingSlot
+{
+    std::atomic<std::uint64_t> sequence {0}; // odd while being written
+    std::uint64_t frame {0};
+    std::uint64_t count {0};
+    std::uint64_t timestamp_ns {0}; // see PointFrameHeader
+    std::uint32_t flags {0};        // PointFrameHeader::has_rgba8
+    std::uint32_t reserved[7] {};
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "the ring needs address-free atomics");
+static_assert(sizeof(PointRingHeader) <= 4096, "the header fits in the first page");
+static_assert(sizeof(PointRingSlot) == 64, "slot data starts on its own cache line");
+
+class PointRing
+{
+public:
+    static constexpr const char* default_name = "/qt-pc-viewer-ring";
+    static constexpr std::uint64_t page_size = 4096;
+
+    // What the consumer reads in place, valid until the slot is reused
+    struct View
+    {
+        const float* positions {nullptr};
+        const std::uint8_t* colors {nullptr}; // nullptr without RGBA8
+        std::size_t count {0};
+        std::uint64_t frame {0};
+        std::uint64_t timestamp_ns {0};
+        const PointRingSlot* slot {nullptr};
+        std::uint64_t sequence {0};
+    };
+
+    PointRing() = default;
+    ~PointRing() { close(); }
+    PointRing(const PointRing&) = delete;
+    PointRing& operator=(const PointRing&) = delete;
+
+    bool create(const std::string& name, const std::uint32_t slot_count, const std::uint64_t slot_capacity);
+    bool open(const std::string& name);
+    void close();
+    bool is_open() const { return nullptr != m_header; }
+
+    std::uint64_t slot_capacity() const { return m_header ? m_header->slot_capacity : 0; }
+    std::uint64_t published() const { return m_header ? m_header->published.load(std::memory_order_acquire) : 0; }
+
+    // Producer
+    PointRingSlot* begin_write(float*& positions, std::uint8_t*& colors);
+    void end_write(PointRingSlot* slot, const std::uint64_t count, const bool has_rgba8);
+
+    // Consumer
+    bool read_latest(View& view) const;
+    bool is_intact(const View& view) const;
+
+private:
+    PointRingSlot* slot(const std::uint64_t index) const;
+
+    std::string m_name;
+    bool m_owner {false};
+    void* m_memory {nullptr};
+    std::size_t m_size {0};
+    PointRingHeader* m_header {nullptr};
+};
+
+inline PointRingSlot*
+PointRing::slot(const std::uint64_t index) const
+{
+    char* base = static_cast<char*>(m_memory) + page_size;
+    return reinterpret_cast<PointRingSlot*>(base + (index % m_header->slot_count) * m_header->slot_stride);
+}
+
+inline bool
+PointRing::create(const std::string& name, const std::uint32_t slot_count, const std::uint64_t slot_capacity)
+{
+    close();
+
+    const std::uint64_t slot_bytes = sizeof(PointRingSlot) + slot_capacity * (3 * sizeof(float) + 4);
+    const std::uint64_t slot_stride = (slot_bytes + page_size - 1) / page_size * page_size;
+    m_size = page_size + slot_count * slot_stride;
+
+    ::shm_unlink(name.c_str()); // left behind by a crashed producer
+    const int fd = ::shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+    if (fd < 0 || ::ftruncate(fd, static_cast<off_t>(m_size)) != 0) {
+        std::cerr << "PointRing: failed to create " << name << ": " << std::strerror(errno) << std::endl;
+        if (fd >= 0)
+            ::close(fd);
+        return false;
+    }
+
+    m_memory = ::mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (MAP_FAILED == m_memory) {
+        m_memory = nullptr;
+        return false;
+    }
+
+    m_header = new (m_memory) PointRingHeader;
+    m_header->slot_count = slot_count;
+    m_header->slot_capacity = slot_capacity;
+    m_header->slot_stride = slot_stride;
+    for (std::uint32_t i=0; i<slot_count; i++)
+        new (slot(i)) PointRingSlot;
+
+    m_name = name;
+    m_owner = true;
+    return true;
+}
+
+inline bool
+PointRing::open(const std::string& name)
+{
+    close();
+
+    const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        std::cerr << "PointRing: no ring " << name << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < page_size) {
+        ::close(fd);
+        return false;
+    }
+
+    m_size = static_cast<std::size_t>(st.st_size);
+    m_memory = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (MAP_FAILED == m_memory) {
+        m_memory = nullptr;
+        return false;
+    }
+
+    m_header = static_cast<PointRingHeader*>(m_memory);
+    if (PointRingHeader::ring_magic != m_header->magic || PointRingHeader::ring_version != m_header->version
+            || 0 == m_header->slot_count || page_size + m_header->slot_count * m_header->slot_stride > m_size) {
+        std::cerr << "PointRing: " << name << " is not a point ring" << std::endl;
+        close();
+        return false;
+    }
+
+    m_name = name;
+    m_owner = false;
+    return true;
+}
+
+inline void
+PointRing::close()
+{
+    if (m_memory)
+        ::munmap(m_memory, m_size);
+    if (m_owner)
+        ::shm_unlink(m_name.c_str());
+
+    m_memory = nullptr;
+    m_header = nullptr;
+    m_owner = false;
+}
+
+inline PointRingSlot*
+PointRing::begin_write(float*& positions, std::uint8_t*& colors)
+{
+    PointRingSlot* s = slot(m_header->published.load(std::memory_order_relaxed));
+    s->sequence.store(s->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release); // odd sequence is visible before any data
+
+    positions = reinterpret_cast<float*>(reinterpret_cast<char*>(s) + sizeof(PointRingSlot));
+    colors = reinterpret_cast<std::uint8_t*>(positions + 3 * m_header->slot_capacity);
+    return s;
+}
+
+inline void
+PointRing::end_write(PointRingSlot* s, const std::uint64_t count, const bool has_rgba8)
+{
+    s->frame = m_header->published.load(std::memory_order_relaxed);
+    s->count = std::min(count, m_header->slot_capacity);
+    s->flags = has_rgba8 ? PointFrameHeader::has_rgba8 : 0;
+    s->timestamp_ns = point_frame_clock_ns();
+    s->sequence.store(s->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    m_header->published.fetch_add(1, std::memory_order_release);
+}
+
+/*!
+ * \brief PointRing::read_latest
+ * \return false if nothing was published or the newest slot is being written
+ */
+inline bool
+PointRing::read_latest(View& view) const
+{
+    const std::uint64_t published = this->published();
+    if (0 == published)
+        return false;
+
+    const PointRingSlot* s = slot(published - 1);
+    view.sequence = s->sequence.load(std::memory_order_acquire);
+    if (view.sequence & 1U)
+        return false;
+
+    view.slot = s;
+    view.frame = s->frame;
+    view.count = static_cast<std::size_t>(std::min(s->count, m_header->slot_capacity));
+    view.timestamp_ns = s->timestamp_ns;
+    view.positions = reinterpret_cast<const float*>(reinterpret_cast<const char*>(s) + sizeof(PointRingSlot));
+    view.colors = (s->flags & PointFrameHeader::has_rgba8) ? reinterpret_cast<const std::uint8_t*>(view.positions + 3 * m_header->slot_capacity) : nullptr;
+    return true;
+}
+
+/*!
+ * \brief PointRing::is_intact
+ * \return true if the producer did not touch the slot since read_latest(...), i.e. everything read in between is consistent
+ */
+inline bool
+PointRing::is_intact(const View& view) const
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return view.slot && view.slot->sequence.load(std::memory_order_relaxed) == view.sequence;
+}
+
+}
+
+#endif // POINTRING_H
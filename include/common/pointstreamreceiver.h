@@ -0,0 +1,213 @@
+#ifndef POINTSTREAMRECEIVER_H
+#define POINTSTREAMRECEIVER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+#include <opengl_helper.hpp>
+#include <pointframe.h>
+#include <localsocket.h>
+
+namespace graphics {
+
+struct PointFrame
+{
+    VertexData vertex_data;
+    std::uint64_t timestamp_ns {0}; // sender clock, see PointFrameHeader
+};
+
+/*!
+ * \brief The PointStreamReceiver class
+ * Listens on a local socket for the point frame protocol (pointframe.h) and decodes the frames
+ * on its own thread into pooled frames. Only the latest frame is kept: a frame not taken before
+ * the next one arrives is dropped and its buffers are reused.
+ */
+class PointStreamReceiver
+{
+public:
+    ~PointStreamReceiver() { stop(); }
+
+    bool listen(const std::string& address);
+    void stop();
+    bool is_listening() const { return m_listen_fd >= 0; }
+    const std::string& address() const { return m_address; }
+
+    std::unique_ptr<PointFrame> take_latest();
+    void recycle(std::unique_ptr<PointFrame> frame);
+
+    std::size_t frames_received() const { return m_frames_received; }
+    std::size_t frames_dropped() const { return m_frames_dropped; }
+    bool is_connected() const { return m_client_fd >= 0; }
+
+private:
+    void receive_loop();
+    bool receive_frame(const int fd, std::vector<std::uint8_t>& colors_rgba8);
+    std::unique_ptr<PointFrame> acquire();
+
+    std::string m_address;
+    std::atomic<int> m_listen_fd {-1};
+    std::atomic<int> m_client_fd {-1};
+    std::atomic<bool> m_stop {false};
+    std::thread m_thread;
+
+    std::mutex m_mutex;
+    std::unique_ptr<PointFrame> m_latest {nullptr};
+    std::vector<std::unique_ptr<PointFrame>> m_pool;
+    static constexpr std::size_t max_pool_size = 3; // being filled, latest, being shown
+
+    std::atomic<std::size_t> m_frames_received {0};
+    std::atomic<std::size_t> m_frames_dropped {0};
+};
+
+inline bool
+PointStreamReceiver::listen(const std::string& address)
+{
+    stop();
+
+    const int fd = open_local_socket(address, true);
+    if (fd < 0)
+        return false;
+
+    m_address = address;
+    m_listen_fd = fd;
+    m_stop = false;
+    m_frames_received = 0;
+    m_frames_dropped = 0;
+    m_thread = std::thread(&PointStreamReceiver::receive_loop, this);
+
+    std::cout << "Waiting for point frames on " << address << std::endl;
+    return true;
+}
+
+inline void
+PointStreamReceiver::stop()
+{
+    m_stop = true;
+
+    // Shutting the sockets down wakes the thread from accept() and recv()
+    const int client_fd = m_client_fd.load();
+    if (client_fd >= 0)
+        ::shutdown(client_fd, SHUT_RDWR);
+    const int listen_fd = m_listen_fd.exchange(-1);
+    if (listen_fd >= 0) {
+        ::shutdown(listen_fd, SHUT_RDWR);
+        ::close(listen_fd);
+    }
+
+    if (m_thread.joinable())
+        m_thread.join();
+
+    LocalSocketAddress a;
+    if (LocalSocketAddress::parse(m_address, a) && a.is_unix)
+        ::unlink(a.path.c_str());
+}
+
+inline std::unique_ptr<PointFrame>
+PointStreamReceiver::take_latest()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::move(m_latest);
+}
+
+inline void
+PointStreamReceiver::recycle(std::unique_ptr<PointFrame> frame)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (frame && m_pool.size() < max_pool_size)
+        m_pool.emplace_back(std::move(frame));
+}
+
+inline std::unique_ptr<PointFrame>
+PointStreamReceiver::acquire()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_pool.empty())
+        return std::make_unique<PointFrame>();
+
+    std::unique_ptr<PointFrame> frame = std::move(m_pool.back());
+    m_pool.pop_back();
+    return frame;
+}
+
+inline void
+PointStreamReceiver::receive_loop()
+{
+    std::vector<std::uint8_t> colors_rgba8;
+
+    while (!m_stop) {
+        const int client_fd = ::accept(m_listen_fd, nullptr, nullptr);
+        if (client_fd < 0)
+            break;
+
+        m_client_fd = client_fd;
+        std::cout << "Point stream sender connected to " << m_address << std::endl;
+        while (!m_stop && receive_frame(client_fd, colors_rgba8)) {}
+        m_client_fd = -1;
+        ::close(client_fd);
+        std::cout << "Point stream sender disconnected" << std::endl;
+    }
+}
+
+inline bool
+PointStreamReceiver::receive_frame(const int fd, std::vector<std::uint8_t>& colors_rgba8)
+{
+    PointFrameHeader header;
+    if (!read_exact(fd, &header, sizeof(header)))
+        return false;
+
+    if (!header.is_valid()) {
+        std::cerr << "PointStreamReceiver: invalid frame header, closing the connection" << std::endl;
+        return false;
+    }
+
+    // Pooled frames keep their capacity, resizing to a similar count does not allocate
+    std::unique_ptr<PointFrame> frame = acquire();
+    VertexData& vertex_data = frame->vertex_data;
+    vertex_data.positions.resize(header.count);
+    vertex_data.attributes.clear();
+    vertex_data.color_type = tinyply::Type::UINT8;
+    vertex_data.has_alpha = true;
+    vertex_data.width = 0;
+    vertex_data.height = 0;
+
+    if (!read_exact(fd, vertex_data.positions.data(), header.positions_bytes()))
+        return false;
+
+    if (header.colors_bytes() > 0) {
+        colors_rgba8.resize(header.colors_bytes());
+        if (!read_exact(fd, colors_rgba8.data(), colors_rgba8.size()))
+            return false;
+
+        vertex_data.colors.resize(header.count);
+        for (std::size_t i=0; i<header.count; i++) {
+            const std::uint8_t* c = colors_rgba8.data() + 4 * i;
+            vertex_data.colors[i] = QVector4D(c[0] / 255.F, c[1] / 255.F, c[2] / 255.F, c[3] / 255.F);
+        }
+    } else {
+        vertex_data.colors.clear();
+    }
+    frame->timestamp_ns = header.timestamp_ns;
+    m_frames_received++;
+
+    // Latest frame wins, an older one that was not shown goes back to the pool
+    std::unique_ptr<PointFrame> dropped;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        dropped = std::move(m_latest);
+        m_latest = std::move(frame);
+    }
+    if (dropped) {
+        m_frames_dropped++;
+        recycle(std::move(dropped));
+    }
+    return true;
+}
+
+}
+
+#endif // POINTSTREAMRECEIVER_H
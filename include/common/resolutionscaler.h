@@ -0,0 +1,41 @@
+#ifndef RESOLUTIONSCALER_H
+#define RESOLUTIONSCALER_H
+
+#include <cmath>
+#include <algorithm>
+
+namespace graphics {
+
+/*!
+ * \brief The ResolutionScaler class
+ * Scale of the render resolution along both axes, driven by the measured frame time. Fill-rate
+ * bound frames cost about the number of pixels, i.e. scale^2, so the scale wanted for the target
+ * is scale * sqrt(target / frame time). It is smoothed to avoid pumping between frames.
+ */
+class ResolutionScaler
+{
+public:
+    float m_target_frame_time {1000.F / 60.F}; // ms
+    float m_min_scale {0.25F};
+
+    float scale() const { return m_scale; }
+    void reset() { m_scale = 1.F; }
+
+    // frame_time of the last frame, rendered at the current scale
+    float update(const double frame_time)
+    {
+        if (frame_time <= 0.)
+            return m_scale;
+
+        const float wanted = m_scale * std::sqrt(m_target_frame_time / static_cast<float>(frame_time));
+        m_scale = std::clamp(0.7F * m_scale + 0.3F * wanted, m_min_scale, 1.F);
+        return m_scale;
+    }
+
+private:
+    float m_scale {1.F};
+};
+
+}
+
+#endif // RESOLUTIONSCALER_H
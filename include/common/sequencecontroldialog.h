@@ -0,0 +1,148 @@
+#ifndef SEQUENCECONTROLDIALOG_H
+#define SEQUENCECONTROLDIALOG_H
+
+#include <QDialog>
+#include <QLabel>
+#include <QPushButton>
+#include <QSlider>
+#include <QSpinBox>
+#include <QTimer>
+#include <QSignalBlocker>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+
+#include <viewerwindow.h>
+
+class SequenceControlDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    SequenceControlDialog(QWidget *parent = nullptr, ViewerWindow *gl_window=nullptr)
+        : QDialog(parent)
+        , m_viewer_window(gl_window)
+    {
+        setWindowTitle("Sequence Playback");
+        setWindowFlags(Qt::Dialog);
+
+        setModal(false);
+        setAttribute(Qt::WA_ShowModal, false); // Set the WA_ShowModal property
+        setWindowModality(Qt::NonModal);
+
+        constexpr int window_width = 450;
+        constexpr int window_height = 120;
+        resize(window_width, window_height);
+        setMinimumSize(QSize(window_width, window_height));
+
+        m_play_btn = new QPushButton("Play");
+        m_play_btn->setCheckable(true);
+
+        m_frame_sld = new QSlider(Qt::Horizontal);
+        m_frame_lbl = new QLabel;
+
+        QLabel* fps_lbl = new QLabel("FPS:");
+        m_fps_sbx = new QSpinBox;
+        m_fps_sbx->setRange(1, 120);
+        m_fps_sbx->setValue(30);
+
+        m_buffer_lbl = new QLabel;
+
+        QHBoxLayout *hlayout_play = new QHBoxLayout;
+        hlayout_play->addWidget(m_play_btn);
+        hlayout_play->addWidget(m_frame_sld);
+        hlayout_play->addWidget(m_frame_lbl);
+
+        QHBoxLayout *hlayout_info = new QHBoxLayout;
+        hlayout_info->addWidget(fps_lbl);
+        hlayout_info->addWidget(m_fps_sbx);
+        hlayout_info->addStretch();
+        hlayout_info->addWidget(m_buffer_lbl);
+
+        QVBoxLayout *main_layout = new QVBoxLayout;
+        main_layout->addLayout(hlayout_play);
+        main_layout->addLayout(hlayout_info);
+        setLayout(main_layout);
+
+        connect(m_play_btn, &QPushButton::toggled, this, &SequenceControlDialog::slot_play_toggled);
+        connect(m_frame_sld, &QSlider::valueChanged, this, &SequenceControlDialog::slot_frame_changed);
+        connect(m_fps_sbx, QOverload<int>::of(&QSpinBox::valueChanged), this, &SequenceControlDialog::slot_fps_changed);
+
+        m_refresh_timer.setInterval(100);
+        connect(&m_refresh_timer, &QTimer::timeout, this, &SequenceControlDialog::slot_refresh);
+        m_refresh_timer.start();
+    }
+
+    void set_gl_window(ViewerWindow* window) { m_viewer_window = window; }
+
+public slots:
+    void slot_play_toggled(bool checked);
+    void slot_frame_changed(int frame);
+    void slot_fps_changed(int fps);
+    void slot_refresh();
+
+private:
+    ViewerWindow* m_viewer_window {nullptr};
+    QPushButton* m_play_btn {nullptr};
+    QSlider* m_frame_sld {nullptr};
+    QLabel* m_frame_lbl {nullptr};
+    QSpinBox* m_fps_sbx {nullptr};
+    QLabel* m_buffer_lbl {nullptr};
+    QTimer m_refresh_timer;
+};
+
+inline
+void SequenceControlDialog::slot_play_toggled(bool checked)
+{
+    if (nullptr == m_viewer_window)
+        return;
+
+    m_viewer_window->set_sequence_fps(m_fps_sbx->value());
+    m_viewer_window->play_sequence(checked);
+    m_play_btn->setText(checked ? "Pause" : "Play");
+}
+
+inline
+void SequenceControlDialog::slot_frame_changed(int frame)
+{
+    if (nullptr == m_viewer_window)
+        return;
+
+    // Scrubbing pauses the playback
+    if (m_play_btn->isChecked())
+        m_play_btn->setChecked(false);
+    m_viewer_window->seek_sequence(static_cast<std::size_t>(frame));
+}
+
+inline
+void SequenceControlDialog::slot_fps_changed(int fps)
+{
+    if (nullptr != m_viewer_window)
+        m_viewer_window->set_sequence_fps(fps);
+}
+
+inline
+void SequenceControlDialog::slot_refresh()
+{
+    if (nullptr == m_viewer_window || !isVisible())
+        return;
+
+    const std::size_t count = m_viewer_window->sequence_size();
+    const std::size_t frame = m_viewer_window->sequence_frame();
+
+    {
+        const QSignalBlocker blocker(m_frame_sld); // not a user seek
+        m_frame_sld->setRange(0, static_cast<int>(count > 0 ? count - 1 : 0));
+        if (!m_frame_sld->isSliderDown())
+            m_frame_sld->setValue(static_cast<int>(frame));
+    }
+    {
+        const QSignalBlocker blocker(m_play_btn);
+        m_play_btn->setChecked(m_viewer_window->is_sequence_playing());
+        m_play_btn->setText(m_play_btn->isChecked() ? "Pause" : "Play");
+    }
+
+    m_frame_lbl->setText(QString("%1 / %2").arg(count > 0 ? frame + 1 : 0).arg(count));
+    m_buffer_lbl->setText(QString("Buffered: %1 / %2  Stalls: %3").arg(m_viewer_window->sequence_ready_count())
+                          .arg(m_viewer_window->sequence_ring_size()).arg(m_viewer_window->sequence_stalls()));
+}
+
+#endif // SEQUENCECONTROLDIALOG_H
@@ -0,0 +1,255 @@
+#ifndef SOFTWARERASTERIZER_H
+#define SOFTWARERASTERIZER_H
+
+#include <bit>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <atomic>
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+
+#include <QVector3D>
+#include <QVector4D>
+#include <QMatrix4x4>
+
+#include <opengl_helper.hpp>
+#include <plyloader.h>
+#include <parallel.hpp>
+
+namespace graphics {
+
+/*!
+ * \brief The SoftwareRasterizer class
+ * Draws points on the CPU, for machines without a GPU where a software OpenGL (llvmpipe) is far
+ * too slow for dense clouds. Each point is a square of point_size pixels.
+ *
+ * Every pixel is one 64-bit word holding the depth in its upper half and the RGBA8 colour in its lower
+ * half. The depth is a float in [0, 1], and positive floats order like their bits, so the nearest point
+ * is kept by an atomic min on the whole word: the threads splat their points without any lock, and the
+ * colour always goes with its depth. The pixels are stored in 8x8 tiles so that the splats of points
+ * close on screen stay in a few cache lines.
+ *
+ * The positions are kept as separate x, y, z arrays and projected in batches by a loop without
+ * branches, which the compiler vectorizes. The splats follow in a second, scalar loop.
+ */
+class SoftwareRasterizer
+{
+public:
+    static constexpr int tile_size = 8;
+    static constexpr std::size_t batch_size = 256;
+    static constexpr std::uint64_t empty_pixel = std::numeric_limits<std::uint64_t>::max();
+
+    // Points in the order they are drawn (a budget draws a prefix), invalid points are left out
+    // \param keep one byte per point, the points with 0 are left out, empty keeps all
+    void set_points(const std::vector<QVector3D>& positions, const std::vector<QVector4D>& colors, const std::vector<std::uint8_t>& keep = {});
+    // Positions (x, y, z float) and RGBA8 colors, e.g. a shared-memory slot. Kept only if is_intact()
+    // confirms that the memory was not modified meanwhile, see GLPointCloudObject::upload_frame(...)
+    bool set_points(const float* positions, const std::uint8_t* colors_rgba8, const std::size_t count, const std::function<bool()>& is_intact);
+    void clear();
+
+    std::size_t size() const {return m_x.size();}
+    std::size_t drawn_count() const {return m_drawn_count;}
+    double render_time() const {return m_render_time;} // ms
+
+    // Draws the first count points into a width x height image
+    void render(const QMatrix4x4& view_projection, const int width, const int height, const int point_size, const std::size_t count);
+
+    // Of the last render(...), rows from the bottom like OpenGL: RGBA8 colours and window depths, 1 where nothing was drawn
+    const std::vector<std::uint32_t>& colors() const {return m_colors_image;}
+    const std::vector<float>& depths() const {return m_depths_image;}
+    int width() const {return m_width;}
+    int height() const {return m_height;}
+
+private:
+    // x and y within the image
+    std::size_t pixel_index(const int x, const int y) const
+    {
+        const std::size_t column = static_cast<std::size_t>(x);
+        const std::size_t row = static_cast<std::size_t>(y);
+        const std::size_t tile = (row / tile_size) * static_cast<std::size_t>(m_tiles_x) + column / tile_size;
+        return tile * tile_size * tile_size + (row % tile_size) * tile_size + column % tile_size;
+    }
+    static std::uint32_t pack_color(const QVector4D& c)
+    {
+        auto channel = [](const float v) { return static_cast<std::uint32_t>(std::clamp(v, 0.F, 1.F) * 255.F + 0.5F); };
+        return channel(c.x()) | (channel(c.y()) << 8) | (channel(c.z()) << 16) | (channel(c.w()) << 24);
+    }
+
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<float> m_z;
+    std::vector<std::uint32_t> m_colors;
+
+    std::vector<std::uint64_t> m_pixels; // depth bits << 32 | colour, tiled
+    std::vector<std::uint32_t> m_colors_image;
+    std::vector<float> m_depths_image;
+    int m_width {0};
+    int m_height {0};
+    int m_tiles_x {0};
+    std::size_t m_drawn_count {0};
+    double m_render_time {0.};
+};
+
+inline void
+SoftwareRasterizer::clear()
+{
+    m_x.clear();
+    m_y.clear();
+    m_z.clear();
+    m_colors.clear();
+    m_drawn_count = 0;
+}
+
+inline void
+SoftwareRasterizer::set_points(const std::vector<QVector3D>& positions, const std::vector<QVector4D>& colors, const std::vector<std::uint8_t>& keep)
+{
+    clear();
+    const std::size_t count = positions.size();
+    m_x.reserve(count);
+    m_y.reserve(count);
+    m_z.reserve(count);
+    m_colors.reserve(count);
+    for (std::size_t i=0; i<count; i++) {
+        if (!is_valid_point(positions[i]) || (!keep.empty() && (i >= keep.size() || !keep[i])))
+            continue;
+        m_x.emplace_back(positions[i].x());
+        m_y.emplace_back(positions[i].y());
+        m_z.emplace_back(positions[i].z());
+        m_colors.emplace_back(i < colors.size() ? pack_color(colors[i]) : 0xFFFFFFFFU);
+    }
+}
+
+inline bool
+SoftwareRasterizer::set_points(const float* positions, const std::uint8_t* colors_rgba8, const std::size_t count, const std::function<bool()>& is_intact)
+{
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<std::uint32_t> colors;
+    x.reserve(count);
+    y.reserve(count);
+    z.reserve(count);
+    colors.reserve(count);
+    for (std::size_t i=0; i<count; i++) {
+        const QVector3D p(positions[3 * i], positions[3 * i + 1], positions[3 * i + 2]);
+        if (!is_valid_point(p))
+            continue;
+        std::uint32_t color = 0xFFFFFFFFU;
+        if (nullptr != colors_rgba8)
+            std::memcpy(&color, colors_rgba8 + 4 * i, sizeof(color));
+        x.emplace_back(p.x());
+        y.emplace_back(p.y());
+        z.emplace_back(p.z());
+        colors.emplace_back(color);
+    }
+
+    if (is_intact && !is_intact())
+        return false;
+
+    m_x = std::move(x);
+    m_y = std::move(y);
+    m_z = std::move(z);
+    m_colors = std::move(colors);
+    return true;
+}
+
+inline void
+SoftwareRasterizer::render(const QMatrix4x4& view_projection, const int width, const int height, const int point_size, const std::size_t count)
+{
+    manual_timer timer;
+    timer.start();
+
+    m_width = std::max(1, width);
+    m_height = std::max(1, height);
+    m_tiles_x = (m_width + tile_size - 1) / tile_size;
+    const int tiles_y = (m_height + tile_size - 1) / tile_size;
+    m_pixels.resize(static_cast<std::size_t>(m_tiles_x) * static_cast<std::size_t>(tiles_y) * tile_size * tile_size);
+    parallel_for(0, m_pixels.size(), 1 << 16, [this](const std::size_t begin, const std::size_t end) {
+        std::fill(m_pixels.begin() + static_cast<std::ptrdiff_t>(begin), m_pixels.begin() + static_cast<std::ptrdiff_t>(end), empty_pixel);
+    });
+
+    std::array<float, 16> m; // column-major
+    std::copy(view_projection.constData(), view_projection.constData() + 16, m.begin());
+    const float half_width = 0.5F * static_cast<float>(m_width);
+    const float half_height = 0.5F * static_cast<float>(m_height);
+    const int extent = std::max(1, point_size);
+    const float offset = 0.5F * static_cast<float>(extent - 1);
+    const float min_screen = static_cast<float>(-extent);
+    const int extent_negative = -extent;
+    const float max_screen_x = static_cast<float>(m_width);
+    const float max_screen_y = static_cast<float>(m_height);
+    m_drawn_count = std::min(count, size());
+
+    // The constants are copied into the threads, through references they would be read again at every point
+    parallel_for(0, m_drawn_count, 1 << 15, [=, this](const std::size_t begin, const std::size_t end) {
+        int screen_x[batch_size];
+        int screen_y[batch_size];
+        float depth[batch_size];
+        for (std::size_t b=begin; b<end; b+=batch_size) {
+            const std::size_t n = std::min(batch_size, end - b);
+            const float* x = m_x.data() + b;
+            const float* y = m_y.data() + b;
+            const float* z = m_z.data() + b;
+
+            // Without branches: points behind the eye get a depth out of [0, 1] instead, and the screen
+            // coordinates are clamped before the conversion so that far away ones do not overflow
+            for (std::size_t k=0; k<n; k++) {
+                const float clip_x = m[0] * x[k] + m[4] * y[k] + m[8] * z[k] + m[12];
+                const float clip_y = m[1] * x[k] + m[5] * y[k] + m[9] * z[k] + m[13];
+                const float clip_z = m[2] * x[k] + m[6] * y[k] + m[10] * z[k] + m[14];
+                const float clip_w = m[3] * x[k] + m[7] * y[k] + m[11] * z[k] + m[15];
+                const bool in_front = clip_w > 1e-6F;
+                const float inverse_w = in_front ? 1.F / clip_w : 0.F;
+                const float sx = std::clamp((clip_x * inverse_w + 1.F) * half_width - offset + 0.5F, min_screen, max_screen_x);
+                const float sy = std::clamp((clip_y * inverse_w + 1.F) * half_height - offset + 0.5F, min_screen, max_screen_y);
+                depth[k] = in_front ? 0.5F * clip_z * inverse_w + 0.5F : 2.F;
+                // Truncated once positive, which floors
+                screen_x[k] = static_cast<int>(sx - min_screen) + extent_negative;
+                screen_y[k] = static_cast<int>(sy - min_screen) + extent_negative;
+            }
+
+            for (std::size_t k=0; k<n; k++) {
+                const int x0 = screen_x[k];
+                const int y0 = screen_y[k];
+                if (depth[k] < 0.F || depth[k] > 1.F || x0 <= extent_negative || y0 <= extent_negative || x0 >= m_width || y0 >= m_height)
+                    continue;
+
+                const std::uint64_t value = (static_cast<std::uint64_t>(std::bit_cast<std::uint32_t>(depth[k])) << 32) | m_colors[b + k];
+                for (int py=std::max(0, y0); py<std::min(m_height, y0 + extent); py++) {
+                    for (int px=std::max(0, x0); px<std::min(m_width, x0 + extent); px++) {
+                        // Atomic min, the plain load skips the points hidden behind the ones already drawn
+                        std::atomic_ref<std::uint64_t> pixel(m_pixels[pixel_index(px, py)]);
+                        std::uint64_t current = pixel.load(std::memory_order_relaxed);
+                        while (value < current && !pixel.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+                    }
+                }
+            }
+        }
+    });
+
+    // Untiled into the images the viewer uploads
+    m_colors_image.resize(static_cast<std::size_t>(m_width) * static_cast<std::size_t>(m_height));
+    m_depths_image.resize(m_colors_image.size());
+    parallel_for(0, static_cast<std::size_t>(m_height), 16, [this](const std::size_t row_begin, const std::size_t row_end) {
+        for (std::size_t row=row_begin; row<row_end; row++) {
+            const std::size_t line = row * static_cast<std::size_t>(m_width);
+            for (int column=0; column<m_width; column++) {
+                const std::uint64_t pixel = m_pixels[pixel_index(column, static_cast<int>(row))];
+                const bool drawn = empty_pixel != pixel;
+                m_colors_image[line + static_cast<std::size_t>(column)] = drawn ? static_cast<std::uint32_t>(pixel) : 0U;
+                m_depths_image[line + static_cast<std::size_t>(column)] = drawn ? std::bit_cast<float>(static_cast<std::uint32_t>(pixel >> 32)) : 1.F;
+            }
+        }
+    });
+
+    timer.stop();
+    m_render_time = timer.get();
+}
+
+}
+
+#endif // SOFTWARERASTERIZER_H
@@ -153,6 +153,7 @@ namespace tinyply
         std::vector<std::string> get_info() const;
         std::vector<std::string> & get_comments();
         bool is_binary_file() const;
+        bool is_big_endian_file() const;
 
         /*
          * In the general case where |list_size_hint| is zero, `read` performs a two-pass
@@ -188,6 +189,7 @@ namespace tinyply
 #include <type_traits>
 #include <iostream>
 #include <cstring>
+#include <limits>
 
 namespace tinyply
 {
@@ -915,9 +917,47 @@ void PlyFile::PlyFileImpl::parse_data(std::istream & is, bool firstPass)
     size_t property_idx = 0;
     ParsingHelper * helper {nullptr};
 
+    // Elements after the last one with requested properties are never touched
+    size_t last_requested_element = 0;
+    for (size_t i = 0; i < element_property_lookup.size(); ++i)
+    {
+        for (auto & lookup : element_property_lookup[i]) if (!lookup.skip) last_requested_element = i + 1;
+    }
+
+    // Elements without requested properties are skipped in bulk: a single seek over
+    // fixed-size binary rows, or one line per row in ascii files.
+    auto skip_element = [this, &element_property_lookup](const PlyElement & element, const size_t idx, std::istream & _is)
+    {
+        if (!isBinary)
+        {
+            _is >> std::ws; // rest of the previous row
+            for (size_t i = 0; i < element.size; ++i) _is.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            return true;
+        }
+
+        size_t row_stride = 0;
+        for (auto & property : element.properties)
+        {
+            if (property.isList) return false; // variable row size, has to be walked
+        }
+        for (auto & lookup : element_property_lookup[idx]) row_stride += lookup.prop_stride;
+        _is.seekg(static_cast<std::streamoff>(row_stride * element.size), std::ios::cur);
+        return true;
+    };
+
     // This is the inner import loop
     for (auto & element : elements)
     {
+        if (element_idx >= last_requested_element) break;
+
+        const bool requested = std::any_of(element_property_lookup[element_idx].begin(), element_property_lookup[element_idx].end(),
+                                           [](const PropertyLookup & lookup) { return !lookup.skip; });
+        if (!requested && skip_element(element, element_idx, is))
+        {
+            element_idx++;
+            continue;
+        }
+
         for (size_t count = 0; count < element.size; ++count)
         {
             property_idx = 0;
@@ -969,6 +1009,7 @@ std::vector<PlyElement> PlyFile::get_elements() const { return impl->elements; }
 std::vector<std::string> & PlyFile::get_comments() { return impl->comments; }
 std::vector<std::string> PlyFile::get_info() const { return impl->objInfo; }
 bool PlyFile::is_binary_file() const { return impl->isBinary; }
+bool PlyFile::is_big_endian_file() const { return impl->isBigEndian; }
 std::shared_ptr<PlyData> PlyFile::request_properties_from_element(const std::string & elementKey,
     const std::vector<std::string> propertyKeys,
     const uint32_t list_size_hint)
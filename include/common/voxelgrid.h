@@ -0,0 +1,204 @@
+#ifndef VOXELGRID_H
+#define VOXELGRID_H
+
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <limits>
+#include <algorithm>
+
+#include <QVector3D>
+#include <QVector4D>
+
+#include <opengl_helper.hpp>
+#include <plyloader.h>
+#include <parallel.hpp>
+
+namespace graphics {
+
+/*!
+ * \brief voxel_downsample
+ * Replaces the points of every occupied voxel of a regular grid by their centroid, with the
+ * average colour and normal when the cloud has them. Extra attributes are not carried over.
+ *
+ * Each point gets a 64-bit voxel key (21 bits per axis). The keys are scattered into shards
+ * by a hash, in parallel over chunks of points with precomputed offsets. Every shard is then
+ * sorted and reduced on its own thread, so no step needs a lock. The output is ordered by
+ * shard and key, the same for any number of threads.
+ * \param voxel_size edge of the voxels, in the units of the positions
+ * \param cancel checked between the steps, an empty cloud is returned when it is set
+ * \param keep one byte per point, the points with 0 are left out (see statistical_outlier_mask(...)), nullptr keeps all
+ * \return an empty cloud if the grid needs more than 2^21 voxels along an axis
+ */
+inline VertexData
+voxel_downsample(const VertexData& input, const float voxel_size, const std::atomic<bool>* cancel = nullptr,
+                 const std::vector<std::uint8_t>* keep = nullptr)
+{
+    constexpr std::uint64_t key_bits = 21;
+    constexpr std::uint64_t key_mask = (std::uint64_t(1) << key_bits) - 1;
+    constexpr std::uint64_t invalid_key = std::numeric_limits<std::uint64_t>::max();
+
+    VertexData output;
+    const std::size_t count = input.positions.size();
+    if (0 == count || voxel_size <= 0.F)
+        return output;
+
+    const bool has_colors = input.colors.size() == count;
+    const bool has_normals = input.normals.size() == count;
+    const std::size_t threads = hardware_threads();
+    const std::size_t chunk = std::max<std::size_t>(1 << 16, (count + threads * 4 - 1) / (threads * 4));
+    const std::size_t chunks_count = (count + chunk - 1) / chunk;
+    auto is_cancelled = [cancel]() { return nullptr != cancel && *cancel; };
+    auto is_kept = [&input, keep](const std::size_t i) {
+        return is_valid_point(input.positions[i]) && (nullptr == keep || (i < keep->size() && (*keep)[i]));
+    };
+
+    // Bounds of the valid points, per chunk then merged
+    std::vector<QVector3D> chunk_min(chunks_count, QVector3D(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()));
+    std::vector<QVector3D> chunk_max(chunks_count, -chunk_min.front());
+    parallel_for(0, chunks_count, 1, [&](const std::size_t c_begin, const std::size_t c_end) {
+        for (std::size_t c=c_begin; c<c_end; c++) {
+            for (std::size_t i=c*chunk; i<std::min(count, (c+1)*chunk); i++) {
+                if (!is_kept(i))
+                    continue;
+                const QVector3D& p = input.positions[i];
+                for (int a=0; a<3; a++) {
+                    chunk_min[c][a] = std::min(chunk_min[c][a], p[a]);
+                    chunk_max[c][a] = std::max(chunk_max[c][a], p[a]);
+                }
+            }
+        }
+    });
+    QVector3D min = chunk_min.front();
+    QVector3D max = chunk_max.front();
+    for (std::size_t c=1; c<chunks_count; c++) {
+        for (int a=0; a<3; a++) {
+            min[a] = std::min(min[a], chunk_min[c][a]);
+            max[a] = std::max(max[a], chunk_max[c][a]);
+        }
+    }
+    if (min.x() > max.x())
+        return output; // no valid point
+
+    for (int a=0; a<3; a++) {
+        if ((max[a] - min[a]) / voxel_size >= static_cast<float>(key_mask)) {
+            std::cerr << "voxel_downsample: voxel size " << voxel_size << " is too small for the extent of the cloud" << std::endl;
+            return output;
+        }
+    }
+
+    const float inverse_size = 1.F / voxel_size;
+    auto voxel_key = [&](const std::size_t i) {
+        if (!is_kept(i))
+            return invalid_key;
+        const QVector3D& p = input.positions[i];
+        const std::uint64_t x = static_cast<std::uint64_t>((p.x() - min.x()) * inverse_size);
+        const std::uint64_t y = static_cast<std::uint64_t>((p.y() - min.y()) * inverse_size);
+        const std::uint64_t z = static_cast<std::uint64_t>((p.z() - min.z()) * inverse_size);
+        return (x & key_mask) | ((y & key_mask) << key_bits) | ((z & key_mask) << (2 * key_bits));
+    };
+    const std::size_t shards_count = threads * 8;
+    auto shard_of = [shards_count](const std::uint64_t key) {
+        return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ULL) >> 32) % shards_count;
+    };
+
+    // Points per shard and chunk, then the offset of every chunk inside every shard
+    std::vector<std::size_t> counts(chunks_count * shards_count, 0);
+    parallel_for(0, chunks_count, 1, [&](const std::size_t c_begin, const std::size_t c_end) {
+        for (std::size_t c=c_begin; c<c_end; c++) {
+            for (std::size_t i=c*chunk; i<std::min(count, (c+1)*chunk); i++) {
+                const std::uint64_t key = voxel_key(i);
+                if (invalid_key != key)
+                    counts[c * shards_count + shard_of(key)]++;
+            }
+        }
+    });
+    if (is_cancelled())
+        return output;
+
+    std::vector<std::size_t> shard_begin(shards_count + 1, 0);
+    std::vector<std::size_t> offsets(chunks_count * shards_count, 0);
+    std::size_t total = 0;
+    for (std::size_t s=0; s<shards_count; s++) {
+        shard_begin[s] = total;
+        for (std::size_t c=0; c<chunks_count; c++) {
+            offsets[c * shards_count + s] = total;
+            total += counts[c * shards_count + s];
+        }
+    }
+    shard_begin[shards_count] = total;
+
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> entries(total); // voxel key, point index
+    parallel_for(0, chunks_count, 1, [&](const std::size_t c_begin, const std::size_t c_end) {
+        for (std::size_t c=c_begin; c<c_end; c++) {
+            std::size_t* offset = offsets.data() + c * shards_count;
+            for (std::size_t i=c*chunk; i<std::min(count, (c+1)*chunk); i++) {
+                const std::uint64_t key = voxel_key(i);
+                if (invalid_key != key)
+                    entries[offset[shard_of(key)]++] = {key, static_cast<std::uint32_t>(i)};
+            }
+        }
+    });
+    if (is_cancelled())
+        return output;
+
+    // Every shard sorted and reduced to one point per voxel
+    std::vector<VertexData> shard_outputs(shards_count);
+    parallel_for(0, shards_count, 1, [&](const std::size_t s_begin, const std::size_t s_end) {
+        for (std::size_t s=s_begin; s<s_end && !is_cancelled(); s++) {
+            auto begin = entries.begin() + static_cast<std::ptrdiff_t>(shard_begin[s]);
+            auto end = entries.begin() + static_cast<std::ptrdiff_t>(shard_begin[s + 1]);
+            std::sort(begin, end);
+
+            VertexData& shard = shard_outputs[s];
+            for (auto run = begin; run != end;) {
+                double sum[3] = {0., 0., 0.};
+                QVector4D color_sum;
+                QVector3D normal_sum;
+                std::size_t n = 0;
+                const std::uint64_t key = run->first;
+                for (; run != end && run->first == key; ++run, n++) {
+                    const QVector3D& p = input.positions[run->second];
+                    sum[0] += p.x();
+                    sum[1] += p.y();
+                    sum[2] += p.z();
+                    if (has_colors)
+                        color_sum += input.colors[run->second];
+                    if (has_normals)
+                        normal_sum += input.normals[run->second];
+                }
+                shard.positions.emplace_back(static_cast<float>(sum[0] / n), static_cast<float>(sum[1] / n), static_cast<float>(sum[2] / n));
+                if (has_colors)
+                    shard.colors.emplace_back(color_sum / static_cast<float>(n));
+                if (has_normals)
+                    shard.normals.emplace_back(normal_sum.normalized());
+            }
+        }
+    });
+    if (is_cancelled())
+        return output;
+
+    std::vector<std::size_t> output_begin(shards_count + 1, 0);
+    for (std::size_t s=0; s<shards_count; s++)
+        output_begin[s + 1] = output_begin[s] + shard_outputs[s].positions.size();
+
+    output.positions.resize(output_begin[shards_count]);
+    output.colors.resize(has_colors ? output.positions.size() : 0);
+    output.normals.resize(has_normals ? output.positions.size() : 0);
+    output.color_type = input.color_type;
+    output.has_alpha = input.has_alpha;
+    parallel_for(0, shards_count, 1, [&](const std::size_t s_begin, const std::size_t s_end) {
+        for (std::size_t s=s_begin; s<s_end; s++) {
+            const VertexData& shard = shard_outputs[s];
+            std::copy(shard.positions.begin(), shard.positions.end(), output.positions.begin() + static_cast<std::ptrdiff_t>(output_begin[s]));
+            std::copy(shard.colors.begin(), shard.colors.end(), output.colors.begin() + static_cast<std::ptrdiff_t>(output_begin[s]));
+            std::copy(shard.normals.begin(), shard.normals.end(), output.normals.begin() + static_cast<std::ptrdiff_t>(output_begin[s]));
+        }
+    });
+
+    return output;
+}
+
+}
+
+#endif // VOXELGRID_H
@@ -0,0 +1,101 @@
+#ifndef GLBUFFERUPLOADER_H
+#define GLBUFFERUPLOADER_H
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+#include <iostream>
+
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLBuffer>
+#include <QOffscreenSurface>
+
+/*!
+ * \brief The GLBufferUploader class
+ * Fills GL buffers on a thread of its own, with a context sharing the objects of the render
+ * context, so that large uploads never stall a rendered frame.
+ *
+ * Jobs run in submission order with the uploader context current: they create their buffers
+ * and copy into them with write(...), which goes through a persistently mapped staging ring
+ * (GL 4.4 or ARB_buffer_storage) in slices of segment_size bytes: every slice is copied into a free
+ * segment of the ring, then by the GPU into the buffer. A fence per segment tells when it can be
+ * reused. Without buffer storage the slices are written with glBufferSubData.
+ *
+ * When a job is done a fence is inserted behind its commands. The render thread must not use the
+ * buffers of a job before is_ready(...) returned true for it: the fence has signalled (polled without
+ * waiting) and the buffers are complete. Without fences (GL < 3.2 and no ARB_sync) the job waits
+ * for the GPU itself with glFinish.
+ */
+class GLBufferUploader
+{
+public:
+    static constexpr std::size_t segment_size = 8 << 20;
+    static constexpr std::size_t segments_count = 4;
+
+    struct Transfer
+    {
+        std::atomic<bool> cancel {false}; // checked by write(...) between slices
+        std::future<bool> result;         // false if the job failed or was cancelled
+        GLsync fence {nullptr};           // inserted behind the commands of the job
+        bool ready {false};
+    };
+    using Job = std::function<bool(GLBufferUploader& uploader, const std::atomic<bool>& cancel)>;
+
+    ~GLBufferUploader();
+
+    // With the render context current, on the GUI thread. false if threaded contexts are not supported
+    bool start();
+    void stop();
+    bool is_running() const {return m_thread.joinable();}
+    bool has_persistent_mapping() const {return m_persistent;} // known once the first job ran
+
+    std::shared_ptr<Transfer> submit(Job job);
+
+    // Render thread, never blocks. true once the buffers of the transfer can be used
+    bool is_ready(Transfer& transfer);
+    // Stops the transfer at its next slice and waits for its job to return
+    void cancel(Transfer& transfer);
+
+    // Uploader thread, inside a job: copies size bytes to offset of a buffer created by the job.
+    // false if cancelled, the buffer is then incomplete
+    bool write(QOpenGLBuffer& buffer, const std::size_t offset, const void* data, const std::size_t size, const std::atomic<bool>& cancel);
+    std::size_t bytes_uploaded() const {return m_bytes_uploaded;}
+
+private:
+    struct Task
+    {
+        Job job;
+        std::shared_ptr<Transfer> transfer;
+        std::promise<bool> promise;
+    };
+
+    void run();
+    void initialize_staging();
+    void destroy_staging();
+
+    std::unique_ptr<QOffscreenSurface> m_surface {nullptr};
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<Task> m_tasks;
+    bool m_stopping {false};
+
+    // Uploader thread only
+    QOpenGLContext* m_context {nullptr};
+    QOpenGLExtraFunctions* m_functions {nullptr};
+    bool m_has_sync {false};
+    GLuint m_staging {0};
+    std::uint8_t* m_staging_memory {nullptr};
+    GLsync m_segment_fences[segments_count] {};
+    std::size_t m_segment {0};
+    std::atomic<bool> m_persistent {false};
+    std::atomic<std::size_t> m_bytes_uploaded {0};
+};
+
+#endif // GLBUFFERUPLOADER_H
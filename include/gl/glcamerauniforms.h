@@ -0,0 +1,74 @@
+#ifndef GLCAMERAUNIFORMS_H
+#define GLCAMERAUNIFORMS_H
+
+#include <cstdint>
+#include <algorithm>
+#include <iostream>
+#include <unordered_map>
+
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QMatrix4x4>
+#include <QByteArray>
+
+#include "camera.h"
+
+/*!
+ * \brief The GLCameraUniforms class
+ * Camera matrices shared by every program, set once per frame instead of once per object.
+ *
+ * With uniform buffers (GL 3.1) the matrices live in a std140 block bound to a fixed binding
+ * point, update(...) rewrites it only when the camera moved and the programs never see them
+ * otherwise. Without, every program holds the same matrices as plain uniforms whose locations
+ * are looked up once, and they are pushed to a program only when it is used after a change.
+ * The shaders are written once for both: shader_header() declares the matrices either way.
+ *
+ * The model matrix of each program is set by set_model(...), through its cached location and only
+ * when it differs from the one the program already has.
+ */
+class GLCameraUniforms
+{
+public:
+    static constexpr GLuint binding_point = 0;
+
+    ~GLCameraUniforms();
+
+    void initialize_gl();
+    void destroy();
+    bool has_uniform_buffer() const {return 0 != m_buffer;}
+
+    // #version line and the declarations of view_matrix, projection_matrix and view_projection_matrix
+    QByteArray shader_header() const;
+
+    // After linking, once per program
+    void attach(QOpenGLShaderProgram* shader);
+
+    // Once per frame, before the programs are used
+    void update(const Camera& camera);
+
+    // Binds the program with the model matrix of the object about to be drawn, and the camera
+    // matrices too without uniform buffers
+    void set_model(QOpenGLShaderProgram* shader, const QMatrix4x4& model_matrix);
+
+private:
+    struct Program
+    {
+        GLint model_matrix {-1};
+        GLint view_matrix {-1};
+        GLint projection_matrix {-1};
+        GLint view_projection_matrix {-1};
+        QMatrix4x4 model;
+        bool has_model {false};
+        std::uint64_t camera_revision {0}; // of the camera matrices it holds, without uniform buffers
+    };
+
+    std::unordered_map<QOpenGLShaderProgram*, Program> m_programs;
+    QMatrix4x4 m_view_matrix;
+    QMatrix4x4 m_projection_matrix;
+    std::uint64_t m_camera_revision {0}; // incremented when the camera moves, 0 before the first update
+    GLuint m_buffer {0};
+    bool m_core_uniform_buffers {false}; // GL 3.1, GLSL 1.40, otherwise through GL_ARB_uniform_buffer_object
+};
+
+#endif // GLCAMERAUNIFORMS_H
@@ -0,0 +1,58 @@
+#ifndef GLEDLOBJECT_H
+#define GLEDLOBJECT_H
+
+#include <memory>
+#include <iostream>
+#include <unordered_map>
+
+#include <QOpenGLVertexArrayObject>
+#include <QOpenGLShaderProgram>
+#include <QVector2D>
+
+#include <glrendertarget.h>
+
+/*!
+ * \brief The GLEdlObject class
+ * Composites the points drawn into a GLRenderTarget, upscaling them when they were drawn at a
+ * lower resolution, optionally with eye-dome lighting.
+ *
+ * Eye-dome lighting darkens every pixel of a GLRenderTarget by how much farther it is than its
+ * screen neighbours, in log depth, which outlines silhouettes and creases without normals. One
+ * full-screen triangle, so the cost depends on the number of pixels and not of points. The depth
+ * is written back with the colour, later passes test against the points as usual.
+ */
+class GLEdlObject
+{
+public:
+    float m_strength {1.F}; // darkening of the depth steps
+    float m_radius {1.5F};  // distance of the neighbours, in pixels
+
+    void initialize_gl();
+    void draw(const GLRenderTarget& target, const float near_plane, const float far_plane, const bool perspective, const bool eye_dome = true);
+
+    void set_shader(QOpenGLShaderProgram* shader);
+    QOpenGLShaderProgram* get_shader_program() {return m_shader;}
+
+private:
+    bool m_initialized {false};
+    std::unique_ptr<QOpenGLVertexArrayObject> m_vao {nullptr}; // empty, the vertices come from gl_VertexID
+    QOpenGLShaderProgram* m_shader {nullptr};
+
+    // Locations of the uniforms set by draw(...), looked up once per program variant by set_shader(...)
+    struct UniformLocations
+    {
+        GLint color_texture {-1};
+        GLint depth_texture {-1};
+        GLint texel_size {-1};
+        GLint uv_scale {-1};
+        GLint radius {-1};
+        GLint strength {-1};
+        GLint near_plane {-1};
+        GLint far_plane {-1};
+        GLint perspective {-1};
+    };
+    std::unordered_map<QOpenGLShaderProgram*, UniformLocations> m_program_locations;
+    UniformLocations m_locations; // of m_shader
+};
+
+#endif // GLEDLOBJECT_H
@@ -0,0 +1,46 @@
+#ifndef GLFRAMETIMER_H
+#define GLFRAMETIMER_H
+
+#include <array>
+#include <memory>
+#include <cstdint>
+#include <iostream>
+
+#include <QOpenGLContext>
+#include <QOpenGLTimerQuery>
+
+/*!
+ * \brief The GLFrameTimer class
+ * GPU time of the frames from GL_TIME_ELAPSED queries. The queries of the last few frames are
+ * kept in flight and read once their result is available, so the CPU never waits for the GPU:
+ * gpu_time() lags the drawn frame by one to three frames. Without timer queries (GL < 3.3 and
+ * no ARB_timer_query) is_supported() is false and nothing is measured.
+ */
+class GLFrameTimer
+{
+public:
+    ~GLFrameTimer();
+
+    void initialize_gl();
+    void destroy();
+
+    // Around the GL commands of a frame, not nested
+    void begin();
+    void end();
+
+    bool is_supported() const {return m_supported;}
+    double gpu_time() const {return m_gpu_time;} // ms of the latest frame measured, 0 before the first one
+
+private:
+    static constexpr std::size_t queries_count = 4;
+    std::array<std::unique_ptr<QOpenGLTimerQuery>, queries_count> m_queries;
+    std::array<std::uint64_t, queries_count> m_query_frame {}; // frame measured by the query, 0 if idle
+    std::size_t m_current {0};     // query of the frame being drawn
+    bool m_measuring {false};      // false when every query is still in flight
+    std::uint64_t m_frame {0};
+    std::uint64_t m_measured_frame {0};
+    bool m_supported {false};
+    double m_gpu_time {0.};
+};
+
+#endif // GLFRAMETIMER_H
@@ -0,0 +1,69 @@
+#ifndef GLHELPERSOBJECT_H
+#define GLHELPERSOBJECT_H
+
+#include <memory>
+#include <vector>
+#include <iostream>
+
+#include <QOpenGLBuffer>
+#include <QOpenGLVertexArrayObject>
+#include <QOpenGLShaderProgram>
+#include <QColor>
+#include <QVector3D>
+#include <QVector4D>
+
+#include <openglwindow.h>
+
+/*!
+ * \brief The GLHelpersObject class
+ * The overlays drawn around the points: the ground grid and, at the center of rotation, the
+ * basis, the camera gizmo and the focal point. All of them live in one interleaved vertex buffer
+ * behind one VAO, created once. The gizmos are stored around the origin, only the model matrix
+ * moves them to the center each frame. The grid is stored in world space and rewritten in place
+ * when its height changes.
+ */
+class GLHelpersObject
+{
+public:
+    void initialize_gl();
+
+    // Grid height below the origin, in meters
+    void set_ground_height(const float height);
+    void draw_ground_grid();
+    // Basis, camera gizmo and focal point, around the origin of the model matrix
+    void draw_center();
+
+    void set_point_size(const float size) {m_point_size = size;}
+    void set_shader(QOpenGLShaderProgram* shader) {m_shader = shader;}
+    QOpenGLShaderProgram* get_shader_program() {return m_shader;}
+
+private:
+    struct Vertex
+    {
+        QVector3D position;
+        QVector4D color;
+    };
+
+    static std::vector<Vertex> generate_ground_grid(const float height);
+    void generate_center(std::vector<Vertex>& vertices);
+
+private:
+    bool m_gl_initialized {false};
+    float m_point_size {15.F};
+    float m_ground_height {1.F};
+
+    // Ranges of the buffer: grid lines, then the gizmo lines, triangles and the focal point
+    GLint m_grid_first {0};
+    GLsizei m_grid_count {0};
+    GLint m_lines_first {0};
+    GLsizei m_lines_count {0};
+    GLint m_triangles_first {0};
+    GLsizei m_triangles_count {0};
+    GLint m_point_first {0};
+
+    std::unique_ptr<QOpenGLVertexArrayObject> m_vao {nullptr};
+    std::unique_ptr<QOpenGLBuffer> m_vbo {nullptr};
+    QOpenGLShaderProgram* m_shader {nullptr};
+};
+
+#endif // GLHELPERSOBJECT_H
@@ -4,6 +4,8 @@
 #include <memory>
 #include <mutex>
 #include <iostream>
+#include <functional>
+#include <unordered_map>
 
 #include <QOpenGLBuffer>
 #include <QOpenGLVertexArrayObject>
@@ -13,6 +15,9 @@
 
 #include <openglwindow.h>
 #include <tinycolormap.hpp>
+#include <parallel.hpp>
+#include <glshaderlibrary.h>
+#include <glbufferuploader.h>
 
 class GLPointCloudObject
 {
@@ -23,6 +28,8 @@ public:
     bool m_z_inversion {false};
     bool m_inverse_depth_colors {false};
     bool m_use_original_colors {true};
+    bool m_shading {true};          // Lambert shading from the normals, when the points have them
+    bool m_size_attenuation {true}; // point size shrinking with the depth, see set_view(...)
 
     enum pc_encoding {
         DEPTH_grayscale,
@@ -31,14 +38,31 @@ public:
         LUT_Heat
     };
     pc_encoding m_pc_encoding {LUT_Turbo};
+    std::string m_color_attribute {}; // name of the vertex attribute colored through the LUT, before the original colors, empty for depth
 
     void initialize_gl();
     void draw(const float point_size);
 
-    void set_shader(QOpenGLShaderProgram* shader) {m_shader = shader;}
+    void set_shader(QOpenGLShaderProgram* shader);
+    void set_view(const QMatrix4x4& model_view_matrix, const float focus_distance);
+    unsigned shader_features() const;
     QOpenGLShaderProgram* get_shader_program() {return m_shader;}
 
-    void set_points(const graphics::VertexData &vertex_data);
+    void set_points(const graphics::VertexData &vertex_data, const std::size_t capacity = 0);
+    void set_points_async(GLBufferUploader& uploader, const graphics::VertexData &vertex_data);
+    bool poll_points(GLBufferUploader& uploader);
+    void cancel_points(GLBufferUploader& uploader);
+    bool is_uploading() const {return nullptr != m_pending || !m_abandoned.empty();}
+    bool append_points(const graphics::VertexData &appended);
+    bool upload_frame(const float* positions, const std::uint8_t* colors_rgba8, const std::size_t count,
+                      const std::function<bool()>& is_intact);
+    void set_indices(const std::vector<std::uint32_t>& indices);
+    void set_point_budget(const float fraction) {m_point_budget = std::clamp(fraction, 0.F, 1.F);}
+    float point_budget() const {return m_point_budget;}
+    std::size_t capacity() const {return m_buffers[m_front].capacity;}
+    std::size_t vertices_count() const {return m_vertices_count;}
+    std::size_t drawn_count() const;
+    bool has_normals() const {return m_has_normals;}
 
     float m_thresh = 0.1F;
 
@@ -48,20 +72,140 @@ public:
 
     QMatrix4x4 get_model_mat();
 
+    // What set_points(...) reads from the settings, copied so that the points can be prepared on another thread
+    struct PointSettings
+    {
+        QVector3D factors {1, 1, 1}; // axis inversions
+        bool use_original_colors {true};
+        bool inverse_depth_colors {false};
+        pc_encoding encoding {LUT_Turbo};
+        float thresh {0.1F};
+        const graphics::PointAttribute* attribute {nullptr}; // colored through the LUT, nullptr for the depth
+    };
+    PointSettings point_settings(const graphics::VertexData &vertex_data) const;
+
+    // Every attribute in the draw order, ready to be copied to the buffers
+    struct PreparedPoints
+    {
+        std::vector<QVector3D> positions;
+        std::vector<QVector4D> colors;
+        std::vector<QVector3D> normals; // empty without normals
+        std::uint64_t order_stride {1};
+        std::uint64_t order_inverse {1};
+        float depth_factor {1.F};
+    };
+    static PreparedPoints prepare_points(const graphics::VertexData &vertex_data, const PointSettings& settings, const std::atomic<bool>* cancel = nullptr);
+
 private:
     bool m_initialized {false};
     std::size_t m_vertices_count {0};
+    bool m_has_normals {false};
+    QMatrix3x3 m_normal_matrix;
+    float m_focus_distance {0.F}; // depth drawn at m_point_size, 0 for the same size at every depth
+    float m_depth_factor {1.F};  // depth colors of appended points use the factor of the whole cloud
+
+    struct VertexBuffers
+    {
+        std::unique_ptr<QOpenGLVertexArrayObject> vao {nullptr};
+        std::unique_ptr<QOpenGLBuffer> position {nullptr};
+        std::unique_ptr<QOpenGLBuffer> color {nullptr};
+        std::unique_ptr<QOpenGLBuffer> normal {nullptr}; // not created for RGBA8 frames
+        std::size_t capacity {0}; // vertices the buffers can hold, the rest is room for append_points(...)
+        bool rgba8 {false};       // colors as normalized RGBA8 instead of float RGBA
+    };
+    // set_points(...) writes the back buffers while the front ones may still be read by the GPU, then swaps
+    VertexBuffers m_buffers[2];
+    std::size_t m_front {0};
 
-    std::unique_ptr<QOpenGLVertexArrayObject> m_vao {nullptr};
+    // set_points(...) uploads point (j * m_order_stride) % count as vertex j: the points are spread
+    // evenly over any prefix of the buffers, a point budget draws a prefix.
+    std::uint64_t m_order_stride {1};
+    std::uint64_t m_order_inverse {1}; // point i is vertex (i * m_order_inverse) % count
+    std::size_t m_ordered_count {0};   // vertices in that order, appended ones follow as they come
+    float m_point_budget {1.F};        // fraction of the ordered vertices drawn, of all of them if none is ordered
+    std::size_t budget_count(const std::size_t count) const;
+    // Drawn by draw() without indices: a prefix from vertex 0, then the appended vertices from m_ordered_count
+    std::size_t prefix_drawn_count() const;
+    std::size_t appended_drawn_count() const;
+    template <typename T, typename Transform>
+    static std::vector<T> to_draw_order(const std::vector<T>& values, const std::uint64_t stride, Transform&& transform);
+
+    // Subset of the vertices drawn instead of all of them, see set_indices(...)
+    std::unique_ptr<QOpenGLBuffer> m_index_buffer {nullptr};
+    std::size_t m_index_count {0};
+    bool m_use_indices {false};
+
+    void create_buffers(VertexBuffers& buffers, const std::size_t capacity, const QOpenGLBuffer::UsagePattern usage, const bool rgba8 = false);
+    void create_vertex_array(VertexBuffers& buffers);
+    static std::unique_ptr<QOpenGLBuffer> create_vertex_buffer(const std::size_t bytes, const QOpenGLBuffer::UsagePattern usage);
+
+    // Buffers filled by the uploader thread, swapped in by poll_points(...) once its fence signalled
+    struct PendingPoints
+    {
+        std::shared_ptr<GLBufferUploader::Transfer> transfer {nullptr};
+        VertexBuffers buffers;          // no vao, it is not shared between contexts
+        std::size_t count {0};
+        std::uint64_t order_stride {1};
+        std::uint64_t order_inverse {1};
+        float depth_factor {1.F};
+        bool has_normals {false};
+    };
+    std::shared_ptr<PendingPoints> m_pending {nullptr};
+    std::vector<std::shared_ptr<PendingPoints>> m_abandoned; // cancelled, released once their job returned
+    void abandon_points();
+    void release_points(GLBufferUploader& uploader, const std::shared_ptr<PendingPoints>& pending);
+    std::vector<std::uint8_t> m_white_rgba8; // colors of uploaded frames without RGBA8
     QOpenGLShaderProgram* m_shader {nullptr};
 
-    std::tuple<float, float> find_min_max(const std::vector<QVector3D> &points, const float& thresh) const;
-    float get_map_factor(const std::vector<QVector3D> &points, const float &thresh) const;
-    std::vector<QVector4D> compute_colors_from_depth(const std::vector<QVector3D>& points, const pc_encoding &encoding) const;
+    // Locations of the uniforms set by draw(...), looked up once per program variant by set_shader(...)
+    struct UniformLocations
+    {
+        GLint point_size {-1};
+        GLint focus_distance {-1};
+        GLint normal_matrix {-1};
+    };
+    std::unordered_map<QOpenGLShaderProgram*, UniformLocations> m_program_locations;
+    UniformLocations m_locations; // of m_shader
+
+    static std::tuple<float, float> find_min_max(const std::vector<QVector3D> &points, const float& thresh);
+    static float get_map_factor(const std::vector<QVector3D> &points, const float &thresh);
+    std::vector<QVector3D> transform_positions(const std::vector<QVector3D>& points) const;
+    static std::vector<QVector4D> compute_colors_from_depth(const std::vector<QVector3D>& points, const float factor, const pc_encoding &encoding, const bool inverse);
+    static std::vector<QVector4D> compute_colors_from_attribute(const graphics::PointAttribute& attribute, const pc_encoding &encoding, const bool inverse);
+    static QVector4D lut_color(const float intensity, const pc_encoding &encoding);
 };
 
+template <typename T, typename Transform>
+inline std::vector<T>
+GLPointCloudObject::to_draw_order(const std::vector<T>& values, const std::uint64_t stride, Transform&& transform)
+{
+    const std::size_t count = values.size();
+    std::vector<T> ordered(count);
+    graphics::parallel_for(0, count, 1 << 16, [&](const std::size_t begin, const std::size_t end) {
+        for (std::size_t j=begin; j<end; j++)
+            ordered[j] = transform(values[static_cast<std::size_t>((j * stride) % count)]);
+    });
+    return ordered;
+}
+
+inline QVector4D
+GLPointCloudObject::lut_color(const float intensity, const pc_encoding &encoding)
+{
+    if (pc_encoding::DEPTH_grayscale == encoding)
+        return QVector4D(intensity, intensity, intensity, 1.0F);
+
+    tinycolormap::ColormapType color_type = tinycolormap::ColormapType::Turbo;
+    if (pc_encoding::LUT_Heat == encoding)
+        color_type = tinycolormap::ColormapType::Heat;
+    else if (pc_encoding::LUT_Jet == encoding)
+        color_type = tinycolormap::ColormapType::Jet;
+
+    const tinycolormap::Color c = tinycolormap::GetColor(static_cast<double>(intensity), color_type);
+    return QVector4D(static_cast<float>(c.r()), static_cast<float>(c.g()),static_cast<float>(c.b()), 1.0F);
+}
+
 inline std::tuple<float, float>
-GLPointCloudObject::find_min_max(const std::vector<QVector3D> &points, const float &thresh) const
+GLPointCloudObject::find_min_max(const std::vector<QVector3D> &points, const float &thresh)
 {
     float min = 100.F;
     float max = -100.F;
@@ -82,7 +226,7 @@ GLPointCloudObject::find_min_max(const std::vector<QVector3D> &points, const flo
 }
 
 inline float
-GLPointCloudObject::get_map_factor(const std::vector<QVector3D> &points, const float& thresh) const
+GLPointCloudObject::get_map_factor(const std::vector<QVector3D> &points, const float& thresh)
 {
     auto [min, max] = find_min_max(points, thresh);
     float div = qFuzzyIsNull(max + min) ? 0.001F : (max + min);
@@ -90,30 +234,51 @@ GLPointCloudObject::get_map_factor(const std::vector<QVector3D> &points, const f
     return 1.F / div;
 }
 
+inline std::vector<QVector3D>
+GLPointCloudObject::transform_positions(const std::vector<QVector3D>& points) const
+{
+    const float factor_x = m_x_inversion ? -1.F : 1.F;
+    const float factor_y = m_y_inversion ? -1.F : 1.F;
+    const float factor_z = m_z_inversion ? -1.F : 1.F;
+
+    std::vector<QVector3D> positions;
+    positions.reserve(points.size());
+    for (const auto &p : points) {
+        positions.emplace_back(factor_x*p.x(), factor_y*p.y(), factor_z*p.z());
+    }
+    return positions;
+}
+
 inline std::vector<QVector4D>
-GLPointCloudObject::compute_colors_from_depth(const std::vector<QVector3D>& points, const pc_encoding& encoding) const
+GLPointCloudObject::compute_colors_from_depth(const std::vector<QVector3D>& points, const float factor, const pc_encoding& encoding, const bool inverse)
 {
-    const float factor = get_map_factor(points, m_thresh);
     std::vector<QVector4D> colors;
     colors.reserve(points.size());
 
-    tinycolormap::ColormapType color_type = tinycolormap::ColormapType::Turbo;
-    if (pc_encoding::LUT_Heat == encoding)
-        color_type = tinycolormap::ColormapType::Heat;
-    else if (pc_encoding::LUT_Jet == encoding)
-        color_type = tinycolormap::ColormapType::Jet;
-
     for (const auto &p : points) {
         const float depth = p.z() < 0 ? p.z()*(-1) : p.z();
-        const float intesity = m_inverse_depth_colors ? std::max(0.F, 1.F - (depth * factor))
+        const float intesity = inverse ? std::max(0.F, 1.F - (depth * factor))
                                                       : std::max(0.F, depth * factor);
+        colors.emplace_back(lut_color(intesity, encoding));
+    }
+
+    return colors;
+}
+
+inline std::vector<QVector4D>
+GLPointCloudObject::compute_colors_from_attribute(const graphics::PointAttribute& attribute, const pc_encoding& encoding, const bool inverse)
+{
+    auto [min, max] = attribute.find_min_max();
+    const float factor = qFuzzyIsNull(max - min) ? 0.F : 1.F / (max - min);
+
+    const std::size_t count = attribute.size();
+    std::vector<QVector4D> colors;
+    colors.reserve(count);
 
-        if (pc_encoding::DEPTH_grayscale == encoding) {
-            colors.emplace_back(intesity, intesity, intesity, 1.0F);
-        } else  {
-            const tinycolormap::Color c = tinycolormap::GetColor(static_cast<double>(intesity), color_type);
-            colors.emplace_back(static_cast<float>(c.r()), static_cast<float>(c.g()),static_cast<float>(c.b()), 1.0F);
-        }
+    for (std::size_t i=0; i<count; i++) {
+        const float normalized = (attribute.value(i) - min) * factor;
+        const float intesity = inverse ? 1.F - normalized : normalized;
+        colors.emplace_back(lut_color(intesity, encoding));
     }
 
     return colors;
@@ -0,0 +1,90 @@
+#ifndef GLRENDERGRAPH_H
+#define GLRENDERGRAPH_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <functional>
+#include <iostream>
+
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+
+#include <glframetimer.h>
+
+/*!
+ * \brief Fixed-function state a pass draws with
+ * The blend function is always source alpha over, only blending itself is switched.
+ */
+struct GLRenderState
+{
+    bool depth_test {true};
+    GLenum depth_func {GL_LESS};
+    bool depth_write {true};
+    bool blend {false};
+
+    bool operator==(const GLRenderState& other) const
+    {
+        return depth_test == other.depth_test && depth_func == other.depth_func && depth_write == other.depth_write && blend == other.blend;
+    }
+    bool operator!=(const GLRenderState& other) const { return !(*this == other); }
+};
+
+/*!
+ * \brief The GLRenderGraph class
+ * The frame as a list of named passes instead of a fixed sequence of draws. A pass declares the
+ * state it draws with (none when it only uploads or reads back) and the passes whose output it
+ * needs. Every frame the passes run in an order respecting these inputs which, among the passes
+ * ready to run, prefers the ones needing no state change; only the state that differs from the
+ * current one is set. Disabled passes and passes whose is_active() is false are skipped, the passes
+ * depending on them still run.
+ *
+ * Each pass is timed on the CPU and, with timer queries, on the GPU (see GLFrameTimer, the GPU
+ * times lag by a few frames).
+ */
+class GLRenderGraph
+{
+public:
+    struct Pass
+    {
+        std::string name;
+        std::optional<GLRenderState> state;   // nullopt for passes that do not draw
+        std::vector<std::string> inputs;      // passes that must run before
+        std::function<bool()> is_active;      // empty for always
+        std::function<void()> execute;
+        bool enabled {true};
+
+        bool executed {false}; // in the last frame
+        double cpu_time {0.};  // ms, of the last execution
+        std::unique_ptr<GLFrameTimer> timer;
+    };
+
+    void initialize_gl();
+    void clear();
+
+    Pass& add_pass(const std::string& name, const std::optional<GLRenderState>& state, const std::vector<std::string>& inputs,
+                   std::function<void()> execute, std::function<bool()> is_active = {});
+    bool set_enabled(const std::string& name, const bool enabled);
+    const Pass* find(const std::string& name) const;
+
+    void execute();
+
+    const std::vector<Pass>& passes() const {return m_passes;}
+    const std::vector<std::size_t>& order() const {return m_order;} // of the last frame, executed or not
+    std::size_t state_changes() const {return m_state_changes;}    // in the last frame
+    bool has_gpu_times() const {return m_gpu_timers;}
+    double gpu_time() const; // ms, sum over the passes executed in the last frame, 0 before the first results
+
+private:
+    void schedule();
+    void apply(const GLRenderState& state);
+
+    std::vector<Pass> m_passes;
+    std::vector<std::size_t> m_order;
+    std::optional<GLRenderState> m_current_state; // unknown at the start of a frame
+    std::size_t m_state_changes {0};
+    bool m_gpu_timers {false};
+};
+
+#endif // GLRENDERGRAPH_H
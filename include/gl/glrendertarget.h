@@ -0,0 +1,53 @@
+#ifndef GLRENDERTARGET_H
+#define GLRENDERTARGET_H
+
+#include <cstdint>
+#include <iostream>
+
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+
+/*!
+ * \brief The GLRenderTarget class
+ * Offscreen framebuffer with a colour (RGBA8) and a depth texture, both readable by a later pass,
+ * e.g. the eye-dome lighting of GLEdlObject. Created and resized lazily with the context current.
+ */
+class GLRenderTarget
+{
+public:
+    ~GLRenderTarget();
+
+    bool resize(const int width, const int height);
+    void destroy();
+
+    // Draws into the target, over scale times its size from the lower left corner. release()
+    // restores the previous framebuffer and viewport.
+    void bind(const float scale = 1.F);
+    void release();
+    // Fills the lower left width x height of the target from the CPU instead of drawing into it,
+    // rows from the bottom: RGBA8 colours and window depths in [0, 1]. Counts as a bind(...) of that size.
+    // false if the image is larger than the target
+    bool upload(const std::uint32_t* colors, const float* depths, const int width, const int height);
+
+    bool is_valid() const {return 0 != m_framebuffer;}
+    int width() const {return m_width;}
+    int height() const {return m_height;}
+    int viewport_width() const {return m_viewport_width;}   // part drawn by the last bind(...)
+    int viewport_height() const {return m_viewport_height;}
+    GLuint color_texture() const {return m_color_texture;}
+    GLuint depth_texture() const {return m_depth_texture;}
+
+private:
+    GLuint m_framebuffer {0};
+    GLuint m_color_texture {0};
+    GLuint m_depth_texture {0};
+    int m_width {0};
+    int m_height {0};
+    int m_viewport_width {0};
+    int m_viewport_height {0};
+
+    GLint m_previous_framebuffer {0};
+    GLint m_previous_viewport[4] {0, 0, 0, 0};
+};
+
+#endif // GLRENDERTARGET_H
@@ -0,0 +1,70 @@
+#ifndef GLSHADERLIBRARY_H
+#define GLSHADERLIBRARY_H
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <iostream>
+
+#include <QOpenGLShaderProgram>
+#include <QByteArray>
+
+#include <glcamerauniforms.h>
+
+/*!
+ * \brief The GLShaderLibrary class
+ * Every program of the viewer, specialized by preprocessor defines instead of uniform branches:
+ * a feature turned off is compiled out of the vertex and fragment paths. A variant is compiled
+ * and linked the first time it is asked for, then kept. The shaders are added as cacheable, so
+ * with a driver supporting program binaries Qt links later launches from its on-disk cache
+ * instead of compiling.
+ *
+ * Attribute locations are bound before linking and the same in every variant, so a VAO set up
+ * with any of them works with all the others.
+ */
+class GLShaderLibrary
+{
+public:
+    enum Program
+    {
+        lines,     // grid and gizmos: position and colour times main_color
+        points,    // the point cloud, round sprites
+        composite  // full-screen pass over a GLRenderTarget
+    };
+
+    enum Feature : unsigned
+    {
+        no_feature = 0,
+        shading = 1 << 0,          // points: headlight from the normals
+        size_attenuation = 1 << 1, // points: size from the depth, see GLPointCloudObject::set_view(...)
+        eye_dome = 1 << 2          // composite: eye-dome lighting, otherwise only upscales
+    };
+
+    enum AttributeLocation : int
+    {
+        position_location = 0,
+        color_location = 1,
+        normal_location = 2,
+        main_color_location = 3
+    };
+
+    ~GLShaderLibrary();
+
+    // The programs are built against the way the camera matrices are shared, and attached to it
+    void initialize_gl(GLCameraUniforms* camera_uniforms);
+    void destroy();
+
+    QOpenGLShaderProgram* program(const Program type, const unsigned features = no_feature);
+
+    std::size_t size() const {return m_programs.size();}
+    double build_time() const {return m_build_time;} // ms, of every variant built so far
+
+private:
+    std::unique_ptr<QOpenGLShaderProgram> build(const Program type, const unsigned features);
+
+    GLCameraUniforms* m_camera_uniforms {nullptr};
+    std::map<std::pair<Program, unsigned>, std::unique_ptr<QOpenGLShaderProgram>> m_programs;
+    double m_build_time {0.};
+};
+
+#endif // GLSHADERLIBRARY_H
@@ -9,6 +9,8 @@
 #include "viewerwindow.h"
 #include "renderingdialog.h"
 #include "pointcloudcontroldialog.h"
+#include "plylibrarydialog.h"
+#include "sequencecontroldialog.h"
 
 class MainWindow : public QMainWindow
 {
@@ -21,14 +23,26 @@ public:
     void create_menu_bar();
     void create_rendering_dialog();
     void create_pc_control_dialog();
+    void create_library_dialog();
+    void create_sequence_dialog();
     void create_about_dialog();
 
 public slots:
     void open_file_dialog();
+    void export_file_dialog();
+    void follow_file(bool checked);
+    void listen_stream(bool checked);
+    void attach_shared_ring(bool checked);
     void open_view(const QString& ply_path);
+    void open_sequence_dialog();
+    void open_depth_image_dialog();
+    void open_depth_sequence_dialog();
     void close_view();
 
 private:
+    void create_view();
+    void uncheck_live_inputs(QAction* except = nullptr);
+    bool find_intrinsics(const QString& path, graphics::CameraIntrinsics& intrinsics);
     void update_stats();
     void reset_camera_view();
 
@@ -38,6 +52,12 @@ private:
     std::unique_ptr<ViewerWindow> m_gl_window {nullptr};
     RenderingDialog* m_rendering_dialog {nullptr};
     PointControlDialog* m_plycontrol_dialog {nullptr};
+    PlyLibraryDialog* m_library_dialog {nullptr};
+    SequenceControlDialog* m_sequence_dialog {nullptr};
+    QAction* m_follow_action {nullptr};
+    QAction* m_stream_action {nullptr};
+    QAction* m_ring_action {nullptr};
+    bool m_software_rendering {false}; // --software, points drawn on the CPU by new views
     QMessageBox* m_about_dialog {nullptr};
 };
 
@@ -106,7 +126,31 @@ void MainWindow::create_pc_control_dialog()
     if (nullptr == m_plycontrol_dialog)
         m_plycontrol_dialog = new PointControlDialog(this, m_gl_window.get());
 
+    m_plycontrol_dialog->refresh_attribute_list();
     m_plycontrol_dialog->show();
 }
 
+inline
+void MainWindow::create_library_dialog()
+{
+    if (nullptr == m_library_dialog) {
+        m_library_dialog = new PlyLibraryDialog(this);
+        connect(m_library_dialog, &PlyLibraryDialog::sig_open_file, this, &MainWindow::open_view);
+    }
+
+    m_library_dialog->show();
+}
+
+inline
+void MainWindow::create_sequence_dialog()
+{
+    if (nullptr == m_gl_window)
+        return;
+
+    if (nullptr == m_sequence_dialog)
+        m_sequence_dialog = new SequenceControlDialog(this, m_gl_window.get());
+
+    m_sequence_dialog->show();
+}
+
 #endif // MainWindow_H
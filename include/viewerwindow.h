@@ -9,22 +9,42 @@
 #include <algorithm>
 #include <thread>
 #include <random>
+#include <chrono>
+#include <future>
 
 #include <QWheelEvent>
 #include <QMouseEvent>
 #include <QOpenGLShaderProgram>
 #include <QLineEdit>
 #include <QLabel>
+#include <QTimer>
 
 #include "openglwindow.h"
 //#include "viewcontroller.h"
 #include "camera.h"
 #include "plyloader.h"
+#include "plywriter.h"
+#include "plytail.h"
+#include "framesequence.h"
+#include "depthimage.h"
+#include "kdtree.h"
+#include "voxelgrid.h"
+#include "outlierfilter.h"
+#include "resolutionscaler.h"
+#include "framegovernor.h"
+#include "pointframe.h"
+#ifdef Q_OS_LINUX
+#include "pointstreamreceiver.h"
+#include "pointring.h"
+#endif
+#include "softwarerasterizer.h"
 #include "glpointcloudobject.h"
-#include "glpointobject.h"
-#include "glbasisobject.h"
-#include "glcameraobject.h"
-#include "glgroundgridobject.h"
+#include "glhelpersobject.h"
+#include "glrendertarget.h"
+#include "gledlobject.h"
+#include "glcamerauniforms.h"
+#include "glshaderlibrary.h"
+#include "glrendergraph.h"
 
 static const QColor red_color = QColor(255,0,0);
 static const QColor green_color = QColor(0,255,0);
@@ -36,22 +56,80 @@ class ViewerWindow : public OpenGLWindow
     Q_OBJECT
 public:
     explicit ViewerWindow(std::shared_ptr<QOpenGLContext> opengl_context=nullptr, QWindow *parent=nullptr);
+    ~ViewerWindow() override;
 
     std::shared_ptr<Camera> m_camera_gl {nullptr};
 
-    std::unique_ptr<GLBasisObject> m_basis_center_object {};
     std::unique_ptr<GLPointCloudObject> m_pointcloud_object {};
-    std::unique_ptr<GLCameraObject> m_camera_object {};
-
-    std::unique_ptr<GLPointObject> m_center_point_object {}; // focal_point
-    std::unique_ptr<GLGroundGridObject> m_ground_grid_object {};
+    std::unique_ptr<GLHelpersObject> m_helpers_object {}; // ground grid, basis, camera and focal point
+    std::unique_ptr<GLEdlObject> m_edl_object {};
+    bool m_eye_dome_lighting {false}; // points drawn offscreen then shaded from their depth, see GLEdlObject
+    bool m_adaptive_resolution {true}; // points drawn at a lower resolution while the view moves, see graphics::ResolutionScaler
+    graphics::ResolutionScaler m_resolution_scaler;
+    bool m_frame_governor_enabled {false}; // quality traded for the target frame time, see graphics::FrameGovernor
+    graphics::FrameGovernor m_frame_governor;
 
     void open_ply(const std::string& fname);
+    bool export_ply(const std::string& fname, const bool is_binary);
+    bool follow_file(const bool enable);
+    bool is_following_file() const {return nullptr != m_tail_reader;}
+
+    bool open_depth_image(const std::string& depth_file, const std::string& color_file, const graphics::CameraIntrinsics& intrinsics);
+
+    bool open_sequence(const std::string& directory);
+    bool open_depth_sequence(const std::string& directory, const graphics::CameraIntrinsics& intrinsics);
+    void play_sequence(const bool play);
+    void seek_sequence(const std::size_t index);
+    void set_sequence_fps(const double fps) {m_sequence_fps = std::max(1., fps);}
+    bool is_sequence_playing() const {return m_sequence_playing;}
+    std::size_t sequence_size() const {return m_sequence ? m_sequence->size() : 0;}
+    std::size_t sequence_frame() const {return m_sequence_shown;}
+    std::size_t sequence_ready_count() const {return m_sequence ? m_sequence->ready_count() : 0;}
+    std::size_t sequence_ring_size() const {return m_sequence ? m_sequence->ring_size() : 0;}
+    std::size_t sequence_stalls() const {return m_sequence_stalls;}
+
+    // Linux only, listen_stream(...) fails elsewhere, see graphics::PointStreamReceiver
+    bool listen_stream(const std::string& address);
+    void stop_stream();
+    bool is_streaming() const;
+    double stream_latency() const {return m_stream_latency;} // ms
+
+    // Linux only (POSIX shared memory), attach_shared_ring(...) fails elsewhere, see graphics::PointRing
+    bool attach_shared_ring(const std::string& name);
+    void detach_shared_ring();
+    bool is_ring_attached() const;
+
+    // Shows the loaded cloud decimated to one point per voxel, the full cloud stays for export. 0 shows every point
+    void set_voxel_size(const float size);
+    float voxel_size() const {return m_voxel_size;}
+
+    // Hides the statistical outliers of the loaded cloud once its k-d tree is built, export keeps every point
+    void set_outlier_filter(const bool enabled, const std::size_t k, const float sigma);
+    bool is_outlier_filter_enabled() const {return m_outlier_enabled;}
+    std::size_t outlier_neighbours() const {return m_outlier_k;}
+    float outlier_sigma() const {return m_outlier_sigma;}
+
+    static constexpr std::size_t normal_neighbours = 16; // k of the PCA normals of clouds loaded without normals
+
+    // k-d tree of the loaded cloud, nullptr while it is built and for live inputs
+    std::shared_ptr<const graphics::KdTree> spatial_index() const {return m_kdtree;}
+
+    std::vector<QString> stats_lines() const;
+    bool m_draw_stats {true};
+    std::vector<std::string> attribute_names() const;
+    bool select_color_attribute(const std::string& name);
     bool m_update_pointcloud {false};
     std::string m_path_file;
 
-    std::unique_ptr<QOpenGLShaderProgram> m_shader;
-    std::unique_ptr<QOpenGLShaderProgram> create_drawing_shader();
+    GLShaderLibrary m_shader_library; // every program, compiled per variant when first used
+
+    // Passes of the frame: upload, points, composite, pick, grid, gizmos. false if there is no such pass
+    bool set_pass_enabled(const std::string& name, const bool enabled) {return m_render_graph.set_enabled(name, enabled);}
+    const GLRenderGraph& render_graph() const {return m_render_graph;}
+
+    // Points drawn by graphics::SoftwareRasterizer on the CPU threads instead of the GPU, then composited
+    void set_software_rendering(const bool enabled);
+    bool is_software_rendering() const {return m_software_rendering;}
 
     bool m_is_left_mouse_pressed {false};
     bool m_is_right_mouse_pressed {false};
@@ -62,7 +140,111 @@ signals:
     void sig_update();
 
 private:
+    void stop_live_inputs();
+    bool start_sequence(std::unique_ptr<graphics::FrameSequence> sequence, const std::string& directory, const std::string& extension);
+    void poll_followed_file();
+    void advance_sequence();
+    void advance_stream();
+    void advance_shared_ring();
+    void build_spatial_index();
+    void drop_spatial_index();
+    void poll_spatial_index();
+    bool pick_center();
+    void build_voxel_grid();
+    void drop_voxel_grid();
+    void poll_voxel_grid();
+    void build_outlier_filter();
+    void drop_outlier_filter();
+    void poll_outlier_filter();
+    void build_normals();
+    void drop_normals();
+    void poll_normals();
+    void build_color_attribute();
+    void drop_color_attribute();
+    void poll_color_attribute();
+    const graphics::VertexData& displayed_vertex_data() const;
+    void build_render_graph();
+    void drop_upload();
+    void upload_software_points();
+
     graphics::VertexData m_point_cloud_vertex_data;
+    graphics::VertexData m_appended_vertex_data; // read from the followed file, not uploaded yet
+    std::unique_ptr<graphics::PlyTailReader> m_tail_reader {nullptr};
+    QTimer m_follow_timer;
+    static constexpr std::size_t follow_min_capacity = 1 << 16; // spare vertices reserved on the GPU when following
+
+    std::unique_ptr<graphics::FrameSequence> m_sequence {nullptr};
+    std::size_t m_sequence_next {0};  // frame shown at the next deadline
+    std::size_t m_sequence_shown {0};
+    bool m_sequence_playing {false};
+    bool m_sequence_seek_pending {false};
+    bool m_sequence_stalled {false};
+    std::size_t m_sequence_stalls {0}; // deadlines missed because the frame was not decoded yet
+    double m_sequence_fps {30.};
+    std::chrono::steady_clock::time_point m_sequence_deadline;
+
+#ifdef Q_OS_LINUX
+    std::unique_ptr<graphics::PointStreamReceiver> m_stream_receiver {nullptr};
+#endif
+    std::uint64_t m_stream_frame_timestamp {0}; // sender timestamp of the frame uploaded this frame, 0 if none
+    double m_stream_latency {0.};              // ms, smoothed, of the stream or the shared-memory ring
+
+#ifdef Q_OS_LINUX
+    std::unique_ptr<graphics::PointRing> m_ring {nullptr};
+#endif
+    bool m_ring_has_frame {false};
+    std::uint64_t m_ring_last_frame {0};
+    std::size_t m_ring_frames_shown {0};
+    std::size_t m_ring_frames_dropped {0}; // skipped by the producer or overwritten during the upload
+
+    float m_voxel_size {0.F};
+    std::unique_ptr<graphics::VertexData> m_voxel_vertex_data {nullptr}; // shown instead of the full cloud
+    double m_voxel_time {0.}; // ms
+    std::future<std::pair<std::unique_ptr<graphics::VertexData>, double>> m_voxel_future;
+    std::shared_ptr<std::atomic<bool>> m_voxel_cancel {nullptr};
+
+    bool m_outlier_enabled {false};
+    std::size_t m_outlier_k {8};
+    float m_outlier_sigma {1.F};
+    std::vector<std::uint8_t> m_keep_mask;       // one byte per point of the loaded cloud, empty if not filtered
+    std::vector<std::uint32_t> m_kept_indices;   // drawn through the index buffer of the point cloud object
+    bool m_update_indices {false};
+    std::size_t m_outliers_removed {0};
+    double m_outlier_time {0.}; // ms
+    std::future<std::pair<std::vector<std::uint8_t>, double>> m_outlier_future;
+    std::shared_ptr<std::atomic<bool>> m_outlier_cancel {nullptr};
+
+    bool m_normals_from_cache {false};
+    double m_normals_time {0.}; // ms, 0 if the normals were not estimated
+    std::future<std::pair<std::vector<QVector3D>, double>> m_normals_future;
+    std::shared_ptr<std::atomic<bool>> m_normals_cancel {nullptr};
+
+    // Column of the selected attribute decoded from the file, the parser cannot be interrupted
+    std::future<graphics::PointAttribute> m_attribute_future;
+
+    GLRenderTarget m_points_target; // points drawn by the eye-dome lighting or at a lower resolution
+    GLBufferUploader m_uploader;    // large clouds are uploaded by its thread, see GLPointCloudObject::set_points_async(...)
+    static constexpr std::size_t async_upload_min_points = 1 << 20; // smaller ones are uploaded within the frame
+    bool m_software_rendering {false};
+    graphics::SoftwareRasterizer m_software_rasterizer; // holds the points shown instead of the GL buffers in software rendering
+    GLRenderGraph m_render_graph;   // the frame, see build_render_graph(). Its GPU time feeds the frame governor
+    struct FrameSettings
+    {
+        float scale {1.F};            // of the points target
+        bool use_target {false};      // points drawn into m_points_target then composited
+        float point_size_scale {1.F};
+    } m_frame;                        // decided by paintGL() for the passes of the frame
+    GLCameraUniforms m_camera_uniforms; // view and projection shared by the programs, see GLShaderLibrary
+    std::chrono::steady_clock::time_point m_last_interaction;
+    static constexpr std::chrono::milliseconds interaction_timeout {250}; // back to full resolution after it
+
+    bool m_pick_pending {false};
+    QPoint m_pick_position;              // window coordinates of the double-click
+    static constexpr int pick_radius = 5; // pixels searched around it for a drawn point
+
+    std::shared_ptr<const graphics::KdTree> m_kdtree {nullptr};
+    std::future<std::shared_ptr<graphics::KdTree>> m_kdtree_future;
+    std::shared_ptr<std::atomic<bool>> m_kdtree_cancel {nullptr};
 
 protected:
     void initialize_gl() override;
@@ -72,6 +254,7 @@ protected:
     void mousePressEvent(QMouseEvent *e) override;
     void mouseReleaseEvent(QMouseEvent *e) override;
     void mouseMoveEvent(QMouseEvent *e) override;
+    void mouseDoubleClickEvent(QMouseEvent *e) override;
     void wheelEvent(QWheelEvent *e) override;
     void keyPressEvent(QKeyEvent *e) override;
     void keyReleaseEvent(QKeyEvent *e) override;
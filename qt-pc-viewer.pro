@@ -20,11 +20,15 @@ SOURCES += \
     src/common/openglwindow.cpp \
     src/common/renderingdialog.cpp \
     src/common/tinyply.cpp \
-    src/gl/glbasisobject.cpp \
     src/gl/glpointcloudobject.cpp \
-    src/gl/glpointobject.cpp \
-    src/gl/glcameraobject.cpp \
-    src/gl/glgroundgridobject.cpp \
+    src/gl/glhelpersobject.cpp \
+    src/gl/glrendertarget.cpp \
+    src/gl/gledlobject.cpp \
+    src/gl/glframetimer.cpp \
+    src/gl/glcamerauniforms.cpp \
+    src/gl/glshaderlibrary.cpp \
+    src/gl/glrendergraph.cpp \
+    src/gl/glbufferuploader.cpp \
 
 HEADERS += \
     include/common/tinycolormap.hpp \
@@ -33,17 +37,47 @@ HEADERS += \
     include/viewerwindow.h \
     include/common/pointcloudcontroldialog.h \
     include/common/plyloader.h \
+    include/common/plywriter.h \
+    include/common/plytail.h \
+    include/common/framesequence.h \
+    include/common/depthimage.h \
+    include/common/normals.h \
+    include/common/kdtree.h \
+    include/common/voxelgrid.h \
+    include/common/outlierfilter.h \
+    include/common/resolutionscaler.h \
+    include/common/framegovernor.h \
+    include/common/softwarerasterizer.h \
+    include/common/sequencecontroldialog.h \
+    include/common/pointframe.h \
+    include/common/plyindex.h \
+    include/common/plylibrarydialog.h \
+    include/common/parallel.hpp \
+    include/common/pointattribute.h \
     include/common/renderingdialog.h \
     include/common/openglwindow.h \
     include/common/graphics_math.hpp \
     include/common/opengl_helper.hpp \
     include/common/camera.h \
-    include/gl/glbasisobject.h \
     include/gl/glpointcloudobject.h \
-    include/gl/glpointobject.h \
-    include/gl/glcameraobject.h \
-    include/gl/glgroundgridobject.h \
+    include/gl/glhelpersobject.h \
+    include/gl/glrendertarget.h \
+    include/gl/gledlobject.h \
+    include/gl/glframetimer.h \
+    include/gl/glcamerauniforms.h \
+    include/gl/glshaderlibrary.h \
+    include/gl/glrendergraph.h \
+    include/gl/glbufferuploader.h \
 
 INCLUDEPATH += $$PWD/include
 INCLUDEPATH += $$PWD/include/gl
 INCLUDEPATH += $$PWD/include/common
+
+# POSIX sockets and shared memory, see ViewerWindow::listen_stream(...) and attach_shared_ring(...)
+linux {
+    HEADERS += \
+        include/common/localsocket.h \
+        include/common/pointstreamreceiver.h \
+        include/common/pointring.h
+    LIBS += -lrt
+}
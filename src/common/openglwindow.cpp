@@ -10,11 +10,8 @@ OpenGLWindow::OpenGLWindow(std::shared_ptr<QOpenGLContext> opengl_context, QWind
     , m_context(opengl_context)
 {
     setSurfaceType(OpenGLSurface);
-    QSurfaceFormat format;
-    format.setSwapBehavior(QSurfaceFormat::DefaultSwapBehavior);
-    format.setSwapInterval(0); // attempt to switch ON the VSync. If =1 then VSync ON. Parameter defines number of frames of delay.
     // Create the native window
-    setFormat(format);
+    setFormat(create_format());
     create();
 
     // Schedule the first update - will happen on the main thread
@@ -0,0 +1,304 @@
+#include "glbufferuploader.h"
+
+#include <cstring>
+#include <algorithm>
+
+#ifndef GL_COPY_READ_BUFFER
+#define GL_COPY_READ_BUFFER 0x8F36
+#endif
+#ifndef GL_COPY_WRITE_BUFFER
+#define GL_COPY_WRITE_BUFFER 0x8F37
+#endif
+#ifndef GL_MAP_WRITE_BIT
+#define GL_MAP_WRITE_BIT 0x0002
+#endif
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#endif
+#ifndef GL_SYNC_FLUSH_COMMANDS_BIT
+#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#endif
+#ifndef GL_ALREADY_SIGNALED
+#define GL_ALREADY_SIGNALED 0x911A
+#endif
+#ifndef GL_CONDITION_SATISFIED
+#define GL_CONDITION_SATISFIED 0x911C
+#endif
+#ifndef GL_TIMEOUT_IGNORED
+#define GL_TIMEOUT_IGNORED 0xFFFFFFFFFFFFFFFFull
+#endif
+
+GLBufferUploader::~GLBufferUploader()
+{
+    stop();
+}
+
+/*!
+ * \brief GLBufferUploader::start
+ * The offscreen surface has to be created on the GUI thread, the context is created by the
+ * uploader thread itself, sharing with the current one.
+ */
+bool GLBufferUploader::start()
+{
+    if (is_running())
+        return true;
+
+    QOpenGLContext* share_context = QOpenGLContext::currentContext();
+    if (nullptr == share_context || !QOpenGLContext::supportsThreadedOpenGL()) {
+        std::cerr << "GLBufferUploader: threaded OpenGL is not supported, buffers are uploaded by the render thread\n";
+        return false;
+    }
+
+    m_surface = std::make_unique<QOffscreenSurface>();
+    m_surface->setFormat(share_context->format());
+    m_surface->create();
+
+    m_stopping = false;
+    std::promise<bool> started;
+    std::future<bool> is_started = started.get_future();
+    m_thread = std::thread([this, share_context, format = share_context->format(), &started]() {
+        QOpenGLContext context;
+        context.setFormat(format);
+        context.setShareContext(share_context);
+        if (!context.create() || !QOpenGLContext::areSharing(&context, share_context) || !context.makeCurrent(m_surface.get())) {
+            std::cerr << "GLBufferUploader: could not create a context sharing with the render context\n";
+            started.set_value(false);
+            return;
+        }
+        m_context = &context;
+        m_functions = context.extraFunctions();
+        initialize_staging();
+        started.set_value(true);
+
+        run();
+
+        destroy_staging();
+        context.doneCurrent();
+        m_context = nullptr;
+        m_functions = nullptr;
+    });
+
+    if (!is_started.get()) {
+        m_thread.join();
+        m_surface.reset();
+        return false;
+    }
+    return true;
+}
+
+void GLBufferUploader::stop()
+{
+    if (!is_running())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        for (Task& task : m_tasks)
+            task.transfer->cancel = true;
+    }
+    m_condition.notify_one();
+    m_thread.join();
+    m_surface.reset();
+}
+
+std::shared_ptr<GLBufferUploader::Transfer> GLBufferUploader::submit(Job job)
+{
+    Task task;
+    task.job = std::move(job);
+    task.transfer = std::make_shared<Transfer>();
+    task.transfer->result = task.promise.get_future();
+    std::shared_ptr<Transfer> transfer = task.transfer;
+
+    if (!is_running()) {
+        task.promise.set_value(false);
+        return transfer;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.emplace_back(std::move(task));
+    }
+    m_condition.notify_one();
+    return transfer;
+}
+
+/*!
+ * \brief GLBufferUploader::run
+ * Runs the jobs until stop(), the ones still queued then are run cancelled so that their own
+ * clean-up happens on this thread with the context current.
+ */
+void GLBufferUploader::run()
+{
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+            if (m_tasks.empty())
+                return;
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+
+        bool succeeded = task.job(*this, task.transfer->cancel);
+        if (succeeded && task.transfer->cancel)
+            succeeded = false;
+        if (succeeded) {
+            // The render thread waits on the fence, flushed so that it signals without this context
+            if (m_has_sync)
+                task.transfer->fence = m_functions->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            if (nullptr != task.transfer->fence)
+                m_functions->glFlush();
+            else
+                m_functions->glFinish();
+        }
+        task.promise.set_value(succeeded);
+    }
+}
+
+bool GLBufferUploader::is_ready(Transfer& transfer)
+{
+    if (transfer.ready)
+        return true;
+    if (!transfer.result.valid() || std::future_status::ready != transfer.result.wait_for(std::chrono::seconds(0)))
+        return false;
+
+    if (nullptr != transfer.fence) {
+        QOpenGLExtraFunctions* f = QOpenGLContext::currentContext()->extraFunctions();
+        const GLenum status = f->glClientWaitSync(transfer.fence, 0, 0);
+        if (GL_ALREADY_SIGNALED != status && GL_CONDITION_SATISFIED != status)
+            return false;
+        f->glDeleteSync(transfer.fence);
+        transfer.fence = nullptr;
+    }
+    transfer.ready = true;
+    return true;
+}
+
+void GLBufferUploader::cancel(Transfer& transfer)
+{
+    transfer.cancel = true;
+    if (transfer.result.valid())
+        transfer.result.wait();
+
+    // No context may be current here, the fence goes with the next job of the uploader
+    if (nullptr != transfer.fence) {
+        submit([fence = transfer.fence](GLBufferUploader& uploader, const std::atomic<bool>&) {
+            uploader.m_functions->glDeleteSync(fence);
+            return true;
+        });
+        transfer.fence = nullptr;
+    }
+}
+
+void GLBufferUploader::initialize_staging()
+{
+    const QSurfaceFormat format = m_context->format();
+    auto is_version = [&format](const int major, const int minor) {
+        return format.majorVersion() > major || (major == format.majorVersion() && format.minorVersion() >= minor);
+    };
+    const bool desktop = !m_context->isOpenGLES();
+    m_has_sync = desktop && (is_version(3, 2) || m_context->hasExtension("GL_ARB_sync"));
+    const bool has_copy = desktop && (is_version(3, 1) || m_context->hasExtension("GL_ARB_copy_buffer"));
+    const bool has_storage = desktop && (is_version(4, 4) || m_context->hasExtension("GL_ARB_buffer_storage"));
+
+    using BufferStorage = void (QOPENGLF_APIENTRYP)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+    BufferStorage buffer_storage = has_storage ? reinterpret_cast<BufferStorage>(m_context->getProcAddress("glBufferStorage")) : nullptr;
+    if (!m_has_sync || !has_copy || nullptr == buffer_storage) {
+        std::cout << "GLBufferUploader: no persistent mapping, buffers are written in slices with glBufferSubData" << std::endl;
+        return;
+    }
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const GLsizeiptr size = static_cast<GLsizeiptr>(segment_size * segments_count);
+    m_functions->glGenBuffers(1, &m_staging);
+    m_functions->glBindBuffer(GL_COPY_READ_BUFFER, m_staging);
+    buffer_storage(GL_COPY_READ_BUFFER, size, nullptr, flags);
+    m_staging_memory = static_cast<std::uint8_t*>(m_functions->glMapBufferRange(GL_COPY_READ_BUFFER, 0, size, flags));
+    m_functions->glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    if (nullptr == m_staging_memory) {
+        std::cerr << "GLBufferUploader: could not map the staging buffer, buffers are written with glBufferSubData\n";
+        destroy_staging();
+        return;
+    }
+    m_persistent = true;
+}
+
+void GLBufferUploader::destroy_staging()
+{
+    for (GLsync& fence : m_segment_fences) {
+        if (nullptr != fence)
+            m_functions->glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (0 != m_staging) {
+        if (nullptr != m_staging_memory) {
+            m_functions->glBindBuffer(GL_COPY_READ_BUFFER, m_staging);
+            m_functions->glUnmapBuffer(GL_COPY_READ_BUFFER);
+            m_functions->glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        }
+        m_functions->glDeleteBuffers(1, &m_staging);
+    }
+    m_staging = 0;
+    m_staging_memory = nullptr;
+    m_persistent = false;
+}
+
+/*!
+ * \brief GLBufferUploader::write
+ * Through the staging ring, a slice waits only for the copy issued segments_count slices before
+ * it. Without it the slices go through glBufferSubData, which the driver may still stage itself,
+ * but this thread is the one waiting.
+ */
+bool GLBufferUploader::write(QOpenGLBuffer& buffer, const std::size_t offset, const void* data, const std::size_t size, const std::atomic<bool>& cancel)
+{
+    const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+    if (!m_persistent) {
+        m_functions->glBindBuffer(GL_ARRAY_BUFFER, buffer.bufferId());
+        for (std::size_t done=0; done<size; done+=segment_size) {
+            if (cancel) {
+                m_functions->glBindBuffer(GL_ARRAY_BUFFER, 0);
+                return false;
+            }
+            const std::size_t slice = std::min(segment_size, size - done);
+            m_functions->glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(offset + done), static_cast<GLsizeiptr>(slice), bytes + done);
+            m_bytes_uploaded += slice;
+        }
+        m_functions->glBindBuffer(GL_ARRAY_BUFFER, 0);
+        return true;
+    }
+
+    m_functions->glBindBuffer(GL_COPY_READ_BUFFER, m_staging);
+    m_functions->glBindBuffer(GL_COPY_WRITE_BUFFER, buffer.bufferId());
+    bool completed = true;
+    for (std::size_t done=0; done<size; done+=segment_size) {
+        if (cancel) {
+            completed = false;
+            break;
+        }
+        GLsync& fence = m_segment_fences[m_segment];
+        if (nullptr != fence) {
+            m_functions->glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            m_functions->glDeleteSync(fence);
+        }
+
+        // Coherent mapping, the copy issued after the memcpy sees it
+        const std::size_t slice = std::min(segment_size, size - done);
+        std::memcpy(m_staging_memory + m_segment * segment_size, bytes + done, slice);
+        m_functions->glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(m_segment * segment_size),
+                                         static_cast<GLintptr>(offset + done), static_cast<GLsizeiptr>(slice));
+        fence = m_functions->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        m_segment = (m_segment + 1) % segments_count;
+        m_bytes_uploaded += slice;
+    }
+    m_functions->glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    m_functions->glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    return completed;
+}
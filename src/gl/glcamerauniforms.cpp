@@ -0,0 +1,134 @@
+#include "glcamerauniforms.h"
+
+#ifndef GL_UNIFORM_BUFFER
+#define GL_UNIFORM_BUFFER 0x8A11
+#endif
+#ifndef GL_INVALID_INDEX
+#define GL_INVALID_INDEX 0xFFFFFFFFu
+#endif
+
+namespace {
+// std140 layout of the Camera block, three column-major mat4
+constexpr GLsizeiptr camera_block_size = 3 * 16 * sizeof(float);
+}
+
+GLCameraUniforms::~GLCameraUniforms()
+{
+    if (nullptr != QOpenGLContext::currentContext())
+        destroy();
+}
+
+void GLCameraUniforms::initialize_gl()
+{
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    const QSurfaceFormat format = context->format();
+    m_core_uniform_buffers = format.majorVersion() > 3 || (3 == format.majorVersion() && format.minorVersion() >= 1);
+    const bool supported = !context->isOpenGLES() && (m_core_uniform_buffers || context->hasExtension("GL_ARB_uniform_buffer_object"));
+    if (!supported) {
+        std::cerr << "GLCameraUniforms: uniform buffers are not supported, the camera matrices are set per program\n";
+        return;
+    }
+
+    QOpenGLExtraFunctions* f = context->extraFunctions();
+    f->glGenBuffers(1, &m_buffer);
+    f->glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+    f->glBufferData(GL_UNIFORM_BUFFER, camera_block_size, nullptr, GL_DYNAMIC_DRAW);
+    f->glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    f->glBindBufferBase(GL_UNIFORM_BUFFER, binding_point, m_buffer);
+}
+
+void GLCameraUniforms::destroy()
+{
+    if (0 != m_buffer)
+        QOpenGLContext::currentContext()->functions()->glDeleteBuffers(1, &m_buffer);
+    m_buffer = 0;
+    m_programs.clear();
+    m_camera_revision = 0;
+}
+
+QByteArray GLCameraUniforms::shader_header() const
+{
+    if (has_uniform_buffer())
+        return QByteArray(m_core_uniform_buffers ? "#version 140\n" : "#version 130\n#extension GL_ARB_uniform_buffer_object : require\n") +
+               "layout(std140) uniform Camera\n"
+               "{\n"
+               "    mat4 view_matrix;\n"
+               "    mat4 projection_matrix;\n"
+               "    mat4 view_projection_matrix;\n"
+               "};\n";
+    return "#version 130\n"
+           "uniform mat4 view_matrix;\n"
+           "uniform mat4 projection_matrix;\n"
+           "uniform mat4 view_projection_matrix;\n";
+}
+
+void GLCameraUniforms::attach(QOpenGLShaderProgram* shader)
+{
+    if (nullptr == shader || !shader->isLinked())
+        return;
+
+    Program program;
+    program.model_matrix = shader->uniformLocation("model_matrix");
+    if (has_uniform_buffer()) {
+        QOpenGLExtraFunctions* f = QOpenGLContext::currentContext()->extraFunctions();
+        const GLuint block = f->glGetUniformBlockIndex(shader->programId(), "Camera");
+        if (GL_INVALID_INDEX != block)
+            f->glUniformBlockBinding(shader->programId(), block, binding_point);
+    } else {
+        program.view_matrix = shader->uniformLocation("view_matrix");
+        program.projection_matrix = shader->uniformLocation("projection_matrix");
+        program.view_projection_matrix = shader->uniformLocation("view_projection_matrix");
+    }
+    m_programs[shader] = program;
+}
+
+void GLCameraUniforms::update(const Camera& camera)
+{
+    const QMatrix4x4 view = camera.get_view_matrix();
+    const QMatrix4x4 projection = camera.get_projection_matrix();
+    if (0 != m_camera_revision && view == m_view_matrix && projection == m_projection_matrix)
+        return;
+
+    m_view_matrix = view;
+    m_projection_matrix = projection;
+    m_camera_revision++;
+
+    if (has_uniform_buffer()) {
+        const QMatrix4x4 view_projection = projection * view;
+        float block[3 * 16];
+        std::copy(view.constData(), view.constData() + 16, block);
+        std::copy(projection.constData(), projection.constData() + 16, block + 16);
+        std::copy(view_projection.constData(), view_projection.constData() + 16, block + 32);
+
+        QOpenGLFunctions* f = QOpenGLContext::currentContext()->functions();
+        f->glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+        f->glBufferSubData(GL_UNIFORM_BUFFER, 0, camera_block_size, block);
+        f->glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+}
+
+void GLCameraUniforms::set_model(QOpenGLShaderProgram* shader, const QMatrix4x4& model_matrix)
+{
+    if (nullptr == shader)
+        return;
+
+    shader->bind();
+    auto it = m_programs.find(shader);
+    if (m_programs.end() == it) {
+        std::cerr << __PRETTY_FUNCTION__ << " program not attached\n";
+        return;
+    }
+
+    Program& program = it->second;
+    if (!program.has_model || program.model != model_matrix) {
+        shader->setUniformValue(program.model_matrix, model_matrix);
+        program.model = model_matrix;
+        program.has_model = true;
+    }
+    if (!has_uniform_buffer() && program.camera_revision != m_camera_revision) {
+        shader->setUniformValue(program.view_matrix, m_view_matrix);
+        shader->setUniformValue(program.projection_matrix, m_projection_matrix);
+        shader->setUniformValue(program.view_projection_matrix, m_projection_matrix * m_view_matrix);
+        program.camera_revision = m_camera_revision;
+    }
+}
@@ -0,0 +1,81 @@
+#include "gledlobject.h"
+
+void GLEdlObject::initialize_gl()
+{
+    if (m_initialized)
+        return;
+
+    m_vao = std::make_unique<QOpenGLVertexArrayObject>();
+    m_vao->create();
+
+    m_initialized = true;
+}
+
+void GLEdlObject::set_shader(QOpenGLShaderProgram* shader)
+{
+    m_shader = shader;
+    if (nullptr == shader || !shader->isLinked())
+        return;
+
+    // The variant without eye_dome has no neighbour uniforms, their locations are -1 and ignored
+    auto it = m_program_locations.find(shader);
+    if (m_program_locations.end() == it) {
+        UniformLocations locations;
+        locations.color_texture = shader->uniformLocation("color_texture");
+        locations.depth_texture = shader->uniformLocation("depth_texture");
+        locations.texel_size = shader->uniformLocation("texel_size");
+        locations.uv_scale = shader->uniformLocation("uv_scale");
+        locations.radius = shader->uniformLocation("radius");
+        locations.strength = shader->uniformLocation("strength");
+        locations.near_plane = shader->uniformLocation("near_plane");
+        locations.far_plane = shader->uniformLocation("far_plane");
+        locations.perspective = shader->uniformLocation("perspective");
+        it = m_program_locations.emplace(shader, locations).first;
+    }
+    m_locations = it->second;
+}
+
+/*!
+ * \brief GLEdlObject::draw
+ * Composites the part of the target drawn by its last bind(...) over the whole bound framebuffer,
+ * pixels where nothing was drawn are discarded. Expects the depth test on with GL_ALWAYS, gl_FragDepth
+ * is written only with the depth test on.
+ * \param near_plane, far_plane of the projection the target was drawn with, to linearize its depth
+ * \param eye_dome false only upscales, the composite variant without eye_dome (see GLShaderLibrary) skips the neighbours
+ */
+void GLEdlObject::draw(const GLRenderTarget& target, const float near_plane, const float far_plane, const bool perspective, const bool eye_dome)
+{
+    if (!m_initialized || !m_shader) {
+        std::cerr << __PRETTY_FUNCTION__ << " not initialized\n";
+        return;
+    }
+    if (!target.is_valid())
+        return;
+
+    QOpenGLFunctions* f = QOpenGLContext::currentContext()->functions();
+
+    m_shader->bind();
+        m_vao->bind();
+        f->glActiveTexture(GL_TEXTURE0);
+        f->glBindTexture(GL_TEXTURE_2D, target.color_texture());
+        f->glActiveTexture(GL_TEXTURE1);
+        f->glBindTexture(GL_TEXTURE_2D, target.depth_texture());
+        m_shader->setUniformValue(m_locations.color_texture, 0);
+        m_shader->setUniformValue(m_locations.depth_texture, 1);
+        m_shader->setUniformValue(m_locations.texel_size, QVector2D(1.F / static_cast<float>(target.width()), 1.F / static_cast<float>(target.height())));
+        m_shader->setUniformValue(m_locations.uv_scale, QVector2D(static_cast<float>(target.viewport_width()) / static_cast<float>(target.width()),
+                                                                  static_cast<float>(target.viewport_height()) / static_cast<float>(target.height())));
+        m_shader->setUniformValue(m_locations.radius, m_radius);
+        m_shader->setUniformValue(m_locations.strength, eye_dome ? m_strength : 0.F);
+        m_shader->setUniformValue(m_locations.near_plane, near_plane);
+        m_shader->setUniformValue(m_locations.far_plane, far_plane);
+        m_shader->setUniformValue(m_locations.perspective, static_cast<GLint>(perspective));
+
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+
+        f->glBindTexture(GL_TEXTURE_2D, 0);
+        f->glActiveTexture(GL_TEXTURE0);
+        f->glBindTexture(GL_TEXTURE_2D, 0);
+        m_vao->release();
+    m_shader->release();
+}
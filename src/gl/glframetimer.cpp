@@ -0,0 +1,77 @@
+#include "glframetimer.h"
+
+GLFrameTimer::~GLFrameTimer()
+{
+    if (nullptr != QOpenGLContext::currentContext())
+        destroy();
+}
+
+void GLFrameTimer::initialize_gl()
+{
+    destroy();
+    m_supported = true;
+    for (auto& query : m_queries) {
+        query = std::make_unique<QOpenGLTimerQuery>();
+        if (!query->create()) {
+            std::cerr << "GLFrameTimer: timer queries are not supported, the frame time is measured on the CPU\n";
+            destroy();
+            return;
+        }
+    }
+}
+
+void GLFrameTimer::destroy()
+{
+    for (auto& query : m_queries) {
+        if (query)
+            query->destroy();
+        query.reset();
+    }
+    m_query_frame.fill(0);
+    m_measuring = false;
+    m_supported = false;
+}
+
+/*!
+ * \brief GLFrameTimer::begin
+ * Collects the results that came back, then starts the query of this frame on a free one. If all
+ * of them are still in flight (a GPU more than queries_count frames behind) this frame is not timed.
+ */
+void GLFrameTimer::begin()
+{
+    if (!m_supported)
+        return;
+
+    m_frame++;
+    for (std::size_t i=0; i<queries_count; i++) {
+        if (0 == m_query_frame[i] || !m_queries[i]->isResultAvailable())
+            continue;
+        if (m_query_frame[i] > m_measured_frame) {
+            m_measured_frame = m_query_frame[i];
+            m_gpu_time = static_cast<double>(m_queries[i]->waitForResult()) * 1e-6;
+        }
+        m_query_frame[i] = 0;
+    }
+
+    m_measuring = false;
+    for (std::size_t k=0; k<queries_count && !m_measuring; k++) {
+        const std::size_t i = (m_current + k) % queries_count;
+        if (0 == m_query_frame[i]) {
+            m_current = i;
+            m_measuring = true;
+        }
+    }
+    if (m_measuring) {
+        m_queries[m_current]->begin();
+        m_query_frame[m_current] = m_frame;
+    }
+}
+
+void GLFrameTimer::end()
+{
+    if (!m_measuring)
+        return;
+    m_queries[m_current]->end();
+    m_current = (m_current + 1) % queries_count;
+    m_measuring = false;
+}
@@ -0,0 +1,184 @@
+#include "glhelpersobject.h"
+
+#include <cmath>
+#include <cstddef>
+
+/*!
+ * \brief GLHelpersObject::generate_ground_grid
+ * Lines fading out from the axes, every tenth one brighter, 20 m wide on the ground plane.
+ */
+std::vector<GLHelpersObject::Vertex> GLHelpersObject::generate_ground_grid(const float height)
+{
+    std::vector<Vertex> vertices;
+    vertices.reserve(199 * 8);
+
+    constexpr float size = 0.1F;
+    constexpr float extent = 99 * size;
+    for (int i=-99; i<=99; i++)
+    {
+        float v = (100.0F - static_cast<float>(std::abs(i))) / 100.0F;
+        if (i%10 != 0)
+        {
+            if (i%5 == 0)
+                v /= 2.0F;
+            else
+                v /= 4.0F;
+        }
+        v *= 0.8F;
+
+        const float shift = static_cast<float>(i) * size;
+
+        vertices.push_back({QVector3D(shift, -height, 0.0F),    QVector4D(1.0F, 1.0F, 1.0F, v)});
+        vertices.push_back({QVector3D(shift, -height, extent),  QVector4D(1.0F, 1.0F, 1.0F, 0.0F)});
+        vertices.push_back({QVector3D(shift, -height, 0.0F),    QVector4D(1.0F, 1.0F, 1.0F, v)});
+        vertices.push_back({QVector3D(shift, -height, -extent), QVector4D(1.0F, 1.0F, 1.0F, 0.0F)});
+
+        vertices.push_back({QVector3D(0.0F, -height, shift),    QVector4D(1.0F, 1.0F, 1.0F, v)});
+        vertices.push_back({QVector3D(extent, -height, shift),  QVector4D(1.0F, .0F, 1.0F, 0.0F)});
+        vertices.push_back({QVector3D(0.0F, -height, shift),    QVector4D(1.0F, 1.0F, 1.0F, v)});
+        vertices.push_back({QVector3D(-extent, -height, shift), QVector4D(1.0F, 1.0F, 1.0F, 0.0F)});
+    }
+
+    return vertices;
+}
+
+/*!
+ * \brief GLHelpersObject::generate_center
+ * Appends the gizmos drawn at the center of rotation, turned 180 degrees around x like the view:
+ * a basis of 0.2 with arrow heads, a cyan camera frustum of 0.1 and the focal point.
+ */
+void GLHelpersObject::generate_center(std::vector<Vertex>& vertices)
+{
+    auto add = [&vertices](const float scale, const QVector3D& p, const QVector4D& color) {
+        vertices.push_back({QVector3D(p.x(), -p.y(), -p.z()) * scale, color});
+    };
+    const QVector4D red(1.0F, 0.0F, 0.0F, 1.0F);
+    const QVector4D green(0.0F, 1.0F, 0.0F, 1.0F);
+    const QVector4D blue(0.0F, 0.0F, 1.0F, 1.0F);
+    const QVector4D cyan(0.0F, 1.0F, 1.0F, 1.0F);
+
+    // Lines: the basis axes, then the camera frustum
+    m_lines_first = static_cast<GLint>(vertices.size());
+    constexpr float basis = 0.2F;
+    add(basis, QVector3D(0.0F, 0.0F, 0.0F), red);   add(basis, QVector3D(1.0F, 0.0F, 0.0F), red);
+    add(basis, QVector3D(0.0F, 0.0F, 0.0F), green); add(basis, QVector3D(0.0F, 1.0F, 0.0F), green);
+    add(basis, QVector3D(0.0F, 0.0F, 0.0F), blue);  add(basis, QVector3D(0.0F, 0.0F, 1.0F), blue);
+
+    constexpr float camera = 0.1F;
+    constexpr float w_d2 = 0.25F;
+    constexpr float h_d2 = 0.25F;
+    const QVector3D corners[4] = {QVector3D(-w_d2, h_d2, 1.0F), QVector3D(w_d2, h_d2, 1.0F), QVector3D(w_d2, -h_d2, 1.0F), QVector3D(-w_d2, -h_d2, 1.0F)};
+    for (int c=0; c<4; c++) {
+        add(camera, corners[c], cyan);
+        add(camera, corners[(c + 1) % 4], cyan);
+    }
+    for (const int c : {0, 3, 1, 2}) { // the two sides to the optical center
+        add(camera, corners[c], cyan);
+        add(camera, QVector3D(0.0F, 0.0F, 0.0F), cyan);
+    }
+    m_lines_count = static_cast<GLsizei>(vertices.size()) - m_lines_first;
+
+    // Arrow heads of the basis
+    m_triangles_first = static_cast<GLint>(vertices.size());
+    constexpr float s = 0.05F;
+    add(basis, QVector3D(1.0F    ,  0.0F, 0.0F), red);
+    add(basis, QVector3D(1.0F - s,  s   , 0.0F), red);
+    add(basis, QVector3D(1.0F - s, -s   , 0.0F), red);
+
+    add(basis, QVector3D(0.0F , 1.0F    , 0.0F), green);
+    add(basis, QVector3D(s    , 1.0F - s, 0.0F), green);
+    add(basis, QVector3D(-s   , 1.0F - s, 0.0F), green);
+
+    add(basis, QVector3D(0.0F, 0.0F     , 1.0F), blue);
+    add(basis, QVector3D(s   , 0.0F,  1.0F - s), blue);
+    add(basis, QVector3D(-s  , 0.0F,  1.0F - s), blue);
+
+    add(basis, QVector3D(0.0F, 0.0F, 1.0F    ), blue);
+    add(basis, QVector3D(0.0F,    s, 1.0F - s), blue);
+    add(basis, QVector3D(0.0F,   -s, 1.0F - s), blue);
+    m_triangles_count = static_cast<GLsizei>(vertices.size()) - m_triangles_first;
+
+    m_point_first = static_cast<GLint>(vertices.size());
+    vertices.push_back({QVector3D(0.0F, 0.0F, 0.0F), QVector4D(1.0F, 1.0F, 0.0F, 0.5F)});
+}
+
+void GLHelpersObject::initialize_gl()
+{
+    if (m_gl_initialized)
+        return;
+    if (!m_shader) {
+        std::cerr << __PRETTY_FUNCTION__  << " Error: No shader initialized\n";
+        return;
+    }
+
+    std::vector<Vertex> vertices = generate_ground_grid(m_ground_height);
+    m_grid_first = 0;
+    m_grid_count = static_cast<GLsizei>(vertices.size());
+    generate_center(vertices);
+
+    m_shader->bind();
+    m_vao = std::make_unique<QOpenGLVertexArrayObject>();
+    m_vao->create();
+    m_vao->bind();
+        m_vbo = std::make_unique<QOpenGLBuffer>(QOpenGLBuffer::VertexBuffer);
+        m_vbo->create();
+        m_vbo->bind();
+        m_vbo->setUsagePattern(QOpenGLBuffer::DynamicDraw);
+        m_vbo->allocate(vertices.data(), static_cast<int>(vertices.size() * sizeof (Vertex)));
+        m_shader->setAttributeBuffer("vertex_position", GL_FLOAT, offsetof(Vertex, position), 3, sizeof (Vertex));
+        m_shader->enableAttributeArray("vertex_position");
+        m_shader->setAttributeBuffer("vertex_color", GL_FLOAT, offsetof(Vertex, color), 4, sizeof (Vertex));
+        m_shader->enableAttributeArray("vertex_color");
+        m_vbo->release();
+    m_vao->release();
+    m_shader->release();
+
+    m_gl_initialized = true;
+}
+
+void GLHelpersObject::set_ground_height(const float height)
+{
+    if (!m_gl_initialized || height == m_ground_height)
+        return;
+
+    m_ground_height = height;
+    const std::vector<Vertex> grid = generate_ground_grid(height);
+    m_vbo->bind();
+    m_vbo->write(static_cast<int>(static_cast<std::size_t>(m_grid_first) * sizeof (Vertex)), grid.data(), static_cast<int>(grid.size() * sizeof (Vertex)));
+    m_vbo->release();
+}
+
+void GLHelpersObject::draw_ground_grid()
+{
+    if (!m_gl_initialized) {
+        std::cerr << __PRETTY_FUNCTION__ << " not initialized\n";
+        return;
+    }
+
+    m_shader->bind();
+        m_vao->bind();
+        m_shader->setAttributeValue("main_color", QColor(255, 255, 255));
+        glDrawArrays(GL_LINES, m_grid_first, m_grid_count);
+        m_vao->release();
+    m_shader->release();
+}
+
+void GLHelpersObject::draw_center()
+{
+    if (!m_gl_initialized) {
+        std::cerr << __PRETTY_FUNCTION__ << " not initialized\n";
+        return;
+    }
+
+    m_shader->bind();
+        m_vao->bind();
+        m_shader->setAttributeValue("main_color", QColor(255, 255, 255));
+        glDrawArrays(GL_LINES, m_lines_first, m_lines_count);
+        glDrawArrays(GL_TRIANGLES, m_triangles_first, m_triangles_count);
+        glPointSize(m_point_size);
+        glEnable(GL_POINT_SMOOTH); // draws rounded points
+        glDrawArrays(GL_POINTS, m_point_first, 1);
+        glDisable(GL_POINT_SMOOTH);
+        m_vao->release();
+    m_shader->release();
+}
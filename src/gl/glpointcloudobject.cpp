@@ -1,5 +1,15 @@
 #include "glpointcloudobject.h"
 
+#include <cmath>
+#include <numeric>
+
+#ifndef GL_PROGRAM_POINT_SIZE
+#define GL_PROGRAM_POINT_SIZE 0x8642
+#endif
+#ifndef GL_POINT_SPRITE
+#define GL_POINT_SPRITE 0x8861
+#endif
+
 void GLPointCloudObject::initialize_gl()
 {
     if (m_initialized)
@@ -10,6 +20,44 @@ void GLPointCloudObject::initialize_gl()
 }
 
 
+/*!
+ * \brief GLPointCloudObject::shader_features
+ * Variant of the points program matching the current settings, see GLShaderLibrary. Shading
+ * needs normals, the size attenuation a perspective view (see set_view(...)).
+ */
+unsigned GLPointCloudObject::shader_features() const
+{
+    unsigned features = GLShaderLibrary::no_feature;
+    if (m_shading && m_has_normals)
+        features |= GLShaderLibrary::shading;
+    if (m_size_attenuation && m_focus_distance > 0.F)
+        features |= GLShaderLibrary::size_attenuation;
+    return features;
+}
+
+std::size_t GLPointCloudObject::budget_count(const std::size_t count) const
+{
+    return std::min(count, static_cast<std::size_t>(std::ceil(static_cast<double>(m_point_budget) * static_cast<double>(count))));
+}
+
+// Without an order (frames, a followed file that was empty) the budget draws a prefix of every vertex
+std::size_t GLPointCloudObject::prefix_drawn_count() const
+{
+    return budget_count(0 == m_ordered_count ? m_vertices_count : m_ordered_count);
+}
+
+std::size_t GLPointCloudObject::appended_drawn_count() const
+{
+    return m_ordered_count > 0 && m_vertices_count > m_ordered_count ? m_vertices_count - m_ordered_count : 0;
+}
+
+std::size_t GLPointCloudObject::drawn_count() const
+{
+    if (m_use_indices)
+        return budget_count(m_index_count);
+    return prefix_drawn_count() + appended_drawn_count();
+}
+
 QMatrix4x4 GLPointCloudObject::get_model_mat()
 {
     QMatrix4x4 m;
@@ -22,6 +70,35 @@ QMatrix4x4 GLPointCloudObject::get_model_mat()
     return m;
 }
 
+/*!
+ * \brief GLPointCloudObject::set_view
+ * \param model_view_matrix of the points, for the normals
+ * \param focus_distance depth at which points are point_size pixels wide, 0 keeps every point at point_size
+ */
+void GLPointCloudObject::set_view(const QMatrix4x4& model_view_matrix, const float focus_distance)
+{
+    m_normal_matrix = model_view_matrix.normalMatrix();
+    m_focus_distance = focus_distance;
+}
+
+void GLPointCloudObject::set_shader(QOpenGLShaderProgram* shader)
+{
+    m_shader = shader;
+    if (nullptr == shader || !shader->isLinked())
+        return;
+
+    // A uniform left out of a variant (no shading, no size attenuation) has location -1, ignored when set
+    auto it = m_program_locations.find(shader);
+    if (m_program_locations.end() == it) {
+        UniformLocations locations;
+        locations.point_size = shader->uniformLocation("point_size");
+        locations.focus_distance = shader->uniformLocation("focus_distance");
+        locations.normal_matrix = shader->uniformLocation("normal_matrix");
+        it = m_program_locations.emplace(shader, locations).first;
+    }
+    m_locations = it->second;
+}
+
 void GLPointCloudObject::draw(const float point_size)
 {
     if (!m_initialized || !m_shader) {
@@ -30,19 +107,182 @@ void GLPointCloudObject::draw(const float point_size)
     }
 
 //    std::cerr << __PRETTY_FUNCTION__ << " m_vertices_count= " << m_vertices_count << "\n";
+    VertexBuffers& front = m_buffers[m_front];
+    if (!front.vao)
+        return;
+
+    // Sizes come from the vertex shader, round points from the fragment shader. Compatibility
+    // contexts before 3.2 fill gl_PointCoord only with point sprites enabled.
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    const bool needs_point_sprite = QSurfaceFormat::CoreProfile != context->format().profile();
+
     m_shader->bind();
-        m_vao->bind();
-//        glPointSize(m_point_size);
-        m_shader->setAttributeValue("main_color", QColor(255,255,255));
-        glPointSize(point_size);
-        glEnable(GL_POINT_SMOOTH); // draws rounded points
-        glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(m_vertices_count));
-        glDisable(GL_POINT_SMOOTH);
-        m_vao->release();
+        front.vao->bind();
+        m_shader->setUniformValue(m_locations.point_size, point_size);
+        m_shader->setUniformValue(m_locations.focus_distance, m_focus_distance);
+        m_shader->setUniformValue(m_locations.normal_matrix, m_normal_matrix);
+        glEnable(GL_PROGRAM_POINT_SIZE);
+        if (needs_point_sprite)
+            glEnable(GL_POINT_SPRITE);
+        if (m_use_indices) {
+            m_index_buffer->bind();
+            glDrawElements(GL_POINTS, static_cast<GLsizei>(budget_count(m_index_count)), GL_UNSIGNED_INT, nullptr);
+        } else {
+            // The ordered part within the budget, then every appended vertex
+            glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(prefix_drawn_count()));
+            if (appended_drawn_count() > 0)
+                glDrawArrays(GL_POINTS, static_cast<GLint>(m_ordered_count), static_cast<GLsizei>(appended_drawn_count()));
+        }
+        if (needs_point_sprite)
+            glDisable(GL_POINT_SPRITE);
+        glDisable(GL_PROGRAM_POINT_SIZE);
+        front.vao->release();
+        if (m_use_indices)
+            m_index_buffer->release();
     m_shader->release();
 }
 
-void GLPointCloudObject::set_points(const graphics::VertexData &vertex_data)
+std::unique_ptr<QOpenGLBuffer> GLPointCloudObject::create_vertex_buffer(const std::size_t bytes, const QOpenGLBuffer::UsagePattern usage)
+{
+    std::unique_ptr<QOpenGLBuffer> buffer = std::make_unique<QOpenGLBuffer>(QOpenGLBuffer::VertexBuffer);
+    buffer->create();
+    buffer->bind();
+    buffer->setUsagePattern(usage);
+    buffer->allocate(static_cast<int>(bytes));
+    buffer->release();
+    return buffer;
+}
+
+void GLPointCloudObject::create_buffers(VertexBuffers& buffers, const std::size_t capacity, const QOpenGLBuffer::UsagePattern usage, const bool rgba8)
+{
+    buffers.capacity = capacity;
+    buffers.rgba8 = rgba8;
+    buffers.position = create_vertex_buffer(capacity * sizeof (QVector3D), usage);
+    buffers.color = create_vertex_buffer(capacity * (rgba8 ? 4 : sizeof (QVector4D)), usage);
+    buffers.normal = rgba8 ? nullptr : create_vertex_buffer(capacity * sizeof (QVector3D), usage);
+    create_vertex_array(buffers);
+}
+
+/*!
+ * \brief GLPointCloudObject::create_vertex_array
+ * Vertex array of buffers already allocated, by this context or by the uploader one.
+ */
+void GLPointCloudObject::create_vertex_array(VertexBuffers& buffers)
+{
+    if (buffers.vao)
+        buffers.vao->destroy();
+
+    buffers.vao = std::make_unique<QOpenGLVertexArrayObject>();
+    buffers.vao->create();
+    buffers.vao->bind();
+        buffers.position->bind();
+        m_shader->setAttributeBuffer(GLShaderLibrary::position_location, GL_FLOAT, 0, 3);
+        m_shader->enableAttributeArray(GLShaderLibrary::position_location);
+        buffers.position->release();
+
+        buffers.color->bind();
+        if (buffers.rgba8) {
+            // QOpenGLShaderProgram can not set up normalized integer attributes
+            QOpenGLContext::currentContext()->functions()->glVertexAttribPointer(GLShaderLibrary::color_location, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, nullptr);
+        } else {
+            m_shader->setAttributeBuffer(GLShaderLibrary::color_location, GL_FLOAT, 0, 4);
+        }
+        m_shader->enableAttributeArray(GLShaderLibrary::color_location);
+        buffers.color->release();
+
+        if (buffers.normal) {
+            buffers.normal->bind();
+            m_shader->setAttributeBuffer(GLShaderLibrary::normal_location, GL_FLOAT, 0, 3);
+            m_shader->enableAttributeArray(GLShaderLibrary::normal_location);
+            buffers.normal->release();
+        } else {
+            m_shader->disableAttributeArray(GLShaderLibrary::normal_location);
+        }
+    buffers.vao->release();
+}
+
+/*!
+ * \brief draw_order_stride
+ * Stride close to count / golden ratio and coprime with it, so that j -> (j * stride) % count is
+ * a permutation whose prefixes sample the whole index range evenly, with its modular inverse.
+ */
+static std::pair<std::uint64_t, std::uint64_t>
+draw_order_stride(const std::size_t count)
+{
+    if (count < 3)
+        return {1, 1};
+
+    const std::int64_t n = static_cast<std::int64_t>(count);
+    std::int64_t stride = std::max<std::int64_t>(1, static_cast<std::int64_t>(std::llround(static_cast<double>(count) * 0.6180339887498949)));
+    while (std::gcd(stride, n) != 1)
+        stride++;
+
+    // Extended Euclid for stride * inverse = 1 mod n
+    std::int64_t r0 = n, r1 = stride, t0 = 0, t1 = 1;
+    while (r1 != 0) {
+        const std::int64_t q = r0 / r1;
+        std::tie(r0, r1) = std::make_pair(r1, r0 - q * r1);
+        std::tie(t0, t1) = std::make_pair(t1, t0 - q * t1);
+    }
+    const std::int64_t inverse = t0 < 0 ? t0 + n : t0;
+    return {static_cast<std::uint64_t>(stride), static_cast<std::uint64_t>(inverse)};
+}
+
+GLPointCloudObject::PointSettings GLPointCloudObject::point_settings(const graphics::VertexData &vertex_data) const
+{
+    PointSettings settings;
+    settings.factors = QVector3D(m_x_inversion ? -1.F : 1.F, m_y_inversion ? -1.F : 1.F, m_z_inversion ? -1.F : 1.F);
+    settings.use_original_colors = m_use_original_colors;
+    settings.inverse_depth_colors = m_inverse_depth_colors;
+    settings.encoding = m_pc_encoding;
+    settings.thresh = m_thresh;
+    for (const auto& a : vertex_data.attributes) {
+        if (a.name == m_color_attribute && a.size() == vertex_data.positions.size())
+            settings.attribute = &a;
+    }
+    return settings;
+}
+
+/*!
+ * \brief GLPointCloudObject::prepare_points
+ * Every attribute gathered in the draw order, with the axis inversions applied on the way. Reads
+ * nothing but its arguments, it runs on the uploader thread for set_points_async(...).
+ * \param cancel checked between the attributes, what is prepared so far is returned when it is set
+ */
+GLPointCloudObject::PreparedPoints GLPointCloudObject::prepare_points(const graphics::VertexData &vertex_data, const PointSettings& settings,
+                                                                      const std::atomic<bool>* cancel)
+{
+    PreparedPoints prepared;
+    const std::size_t count = vertex_data.positions.size();
+    std::tie(prepared.order_stride, prepared.order_inverse) = draw_order_stride(count);
+    const QVector3D factors = settings.factors;
+    auto invert = [factors](const QVector3D& v) { return v * factors; };
+    auto keep = [](const QVector4D& c) { return c; };
+
+    auto is_cancelled = [cancel]() { return nullptr != cancel && *cancel; };
+
+    prepared.positions = to_draw_order(vertex_data.positions, prepared.order_stride, invert);
+    if (is_cancelled())
+        return prepared;
+    prepared.depth_factor = get_map_factor(vertex_data.positions, settings.thresh);
+    // An attribute picked as the source wins over the original colors
+    if (nullptr != settings.attribute) {
+        const std::vector<QVector4D> colors = compute_colors_from_attribute(*settings.attribute, settings.encoding, settings.inverse_depth_colors);
+        prepared.colors = to_draw_order(colors, prepared.order_stride, keep);
+    } else if (vertex_data.colors.size() != count || !settings.use_original_colors) {
+        const std::vector<QVector4D> colors = compute_colors_from_depth(vertex_data.positions, prepared.depth_factor, settings.encoding, settings.inverse_depth_colors);
+        prepared.colors = to_draw_order(colors, prepared.order_stride, keep);
+    } else {
+        prepared.colors = to_draw_order(vertex_data.colors, prepared.order_stride, keep);
+    }
+
+    // Normals go through the same axis inversions as the positions
+    if (vertex_data.normals.size() == count && !is_cancelled())
+        prepared.normals = to_draw_order(vertex_data.normals, prepared.order_stride, invert);
+    return prepared;
+}
+
+void GLPointCloudObject::set_points(const graphics::VertexData &vertex_data, const std::size_t capacity)
 {
     if (!m_initialized) {
         std::cerr << __PRETTY_FUNCTION__ << " not initialized\n";
@@ -53,51 +293,297 @@ void GLPointCloudObject::set_points(const graphics::VertexData &vertex_data)
         std::cerr << "GLPointCloudObject::set_points shader is not created, doing nothing\n";
         return;
     }
-    m_vertices_count = vertex_data.positions.size();
-
-    if (m_vao)
-        m_vao->destroy();
+    abandon_points();
+    const std::size_t count = vertex_data.positions.size();
+    const std::size_t needed_capacity = std::max(count, capacity);
 
+    // Back buffers are reused while they fit, e.g. frames of a sequence, and reallocated when much too big
     m_shader->bind();
-    m_vao = std::make_unique<QOpenGLVertexArrayObject>();
-    m_vao->create();
-    m_vao->bind();
-        std::unique_ptr<QOpenGLBuffer> vbo_position = std::make_unique<QOpenGLBuffer>(QOpenGLBuffer::VertexBuffer);
-        vbo_position->create();
-        vbo_position->bind();
-        vbo_position->setUsagePattern(QOpenGLBuffer::StaticDraw);
-        if (m_x_inversion || m_y_inversion || m_z_inversion) { // inverse x,y,z
-            std::vector<QVector3D> positions; positions.reserve(positions.size());
-            const float factor_x = m_x_inversion ? -1.F : 1.F;
-            const float factor_y = m_y_inversion ? -1.F : 1.F;
-            const float factor_z = m_z_inversion ? -1.F : 1.F;
-            for (const auto &p : vertex_data.positions) {
-                positions.emplace_back(factor_x*p.x(), factor_y*p.y(), factor_z*p.z());
-            }
-            vbo_position->allocate(positions.data(), static_cast<int>(positions.size() * sizeof (QVector3D))); // allocate with writing
+    VertexBuffers& back = m_buffers[1 - m_front];
+    if (!back.vao || back.rgba8 || !back.normal || back.capacity < needed_capacity || back.capacity > 2 * needed_capacity) {
+        const bool is_static = needed_capacity == count && !m_buffers[m_front].vao;
+        create_buffers(back, needed_capacity, is_static ? QOpenGLBuffer::StaticDraw : QOpenGLBuffer::DynamicDraw);
+    }
+
+    const PreparedPoints prepared = prepare_points(vertex_data, point_settings(vertex_data));
+    back.position->bind();
+    back.position->write(0, prepared.positions.data(), static_cast<int>(count * sizeof (QVector3D)));
+    back.position->release();
+    back.color->bind();
+    back.color->write(0, prepared.colors.data(), static_cast<int>(count * sizeof (QVector4D)));
+    back.color->release();
+    if (!prepared.normals.empty()) {
+        back.normal->bind();
+        back.normal->write(0, prepared.normals.data(), static_cast<int>(count * sizeof (QVector3D)));
+        back.normal->release();
+    }
+    m_shader->release();
+
+    m_front = 1 - m_front;
+    m_vertices_count = count;
+    m_ordered_count = count;
+    m_order_stride = prepared.order_stride;
+    m_order_inverse = prepared.order_inverse;
+    m_depth_factor = prepared.depth_factor;
+    m_has_normals = !prepared.normals.empty();
+    m_use_indices = false;
+}
+
+/*!
+ * \brief GLPointCloudObject::set_points_async
+ * Same as set_points(...) without spare capacity, but prepared and uploaded by the uploader thread
+ * into buffers of their own: the points drawn so far stay until poll_points(...) swaps the new
+ * ones in. vertex_data is read in place until then, cancel_points(...) before modifying it.
+ */
+void GLPointCloudObject::set_points_async(GLBufferUploader& uploader, const graphics::VertexData &vertex_data)
+{
+    if (!m_initialized || nullptr == m_shader)
+        return;
+
+    abandon_points();
+    std::shared_ptr<PendingPoints> pending = std::make_shared<PendingPoints>();
+    pending->transfer = uploader.submit([pending_points = pending, &vertex_data, settings = point_settings(vertex_data)](GLBufferUploader& uploader, const std::atomic<bool>& cancel) {
+        PendingPoints& pending = *pending_points;
+        const PreparedPoints prepared = prepare_points(vertex_data, settings, &cancel);
+        if (cancel)
+            return false;
+
+        const std::size_t count = prepared.positions.size();
+        VertexBuffers& buffers = pending.buffers;
+        buffers.capacity = count;
+        buffers.position = create_vertex_buffer(count * sizeof (QVector3D), QOpenGLBuffer::StaticDraw);
+        buffers.color = create_vertex_buffer(count * sizeof (QVector4D), QOpenGLBuffer::StaticDraw);
+        if (!prepared.normals.empty())
+            buffers.normal = create_vertex_buffer(count * sizeof (QVector3D), QOpenGLBuffer::StaticDraw);
+        if (!uploader.write(*buffers.position, 0, prepared.positions.data(), count * sizeof (QVector3D), cancel)
+                || !uploader.write(*buffers.color, 0, prepared.colors.data(), count * sizeof (QVector4D), cancel)
+                || (buffers.normal && !uploader.write(*buffers.normal, 0, prepared.normals.data(), count * sizeof (QVector3D), cancel)))
+            return false;
+
+        pending.count = count;
+        pending.order_stride = prepared.order_stride;
+        pending.order_inverse = prepared.order_inverse;
+        pending.depth_factor = prepared.depth_factor;
+        pending.has_normals = !prepared.normals.empty();
+        return true;
+    });
+    m_pending = std::move(pending);
+}
+
+/*!
+ * \brief GLPointCloudObject::poll_points
+ * Once per frame on the render thread, never waits for the uploader.
+ * \return true when the points of set_points_async(...) were swapped in, the indices have to be set again
+ */
+bool GLPointCloudObject::poll_points(GLBufferUploader& uploader)
+{
+    for (auto it = m_abandoned.begin(); it != m_abandoned.end();) {
+        if (uploader.is_ready(*(*it)->transfer)) {
+            release_points(uploader, *it);
+            it = m_abandoned.erase(it);
         } else {
-            vbo_position->allocate(vertex_data.positions.data(), static_cast<int>(vertex_data.positions.size() * sizeof (QVector3D))); // allocate with writing
+            ++it;
         }
-        m_shader->setAttributeBuffer("vertex_position", GL_FLOAT, 0, 3);
-        m_shader->enableAttributeArray("vertex_position");
-        vbo_position->release();
-
-        std::unique_ptr<QOpenGLBuffer> vbo_color = std::make_unique<QOpenGLBuffer>(QOpenGLBuffer::VertexBuffer);
-        vbo_color->create();
-        vbo_color->bind();
-        vbo_color->setUsagePattern(QOpenGLBuffer::StaticDraw);
-        if (vertex_data.colors.size() == 0 || !m_use_original_colors){
-            std::vector<QVector4D> colors = compute_colors_from_depth(vertex_data.positions, m_pc_encoding);
-            vbo_color->allocate(colors.data(), static_cast<int>(colors.size() * sizeof (QVector4D))); // allocate with writing
+    }
+
+    if (nullptr == m_pending || !uploader.is_ready(*m_pending->transfer))
+        return false;
+
+    std::shared_ptr<PendingPoints> pending = std::move(m_pending);
+    if (!pending->transfer->result.get()) {
+        release_points(uploader, pending);
+        return false;
+    }
+
+    // Objects written by another context are seen here once bound again, which creating the vertex array does
+    VertexBuffers& back = m_buffers[1 - m_front];
+    back.position = std::move(pending->buffers.position);
+    back.color = std::move(pending->buffers.color);
+    back.normal = std::move(pending->buffers.normal);
+    back.capacity = pending->buffers.capacity;
+    back.rgba8 = false;
+    m_shader->bind();
+    create_vertex_array(back);
+    m_shader->release();
+
+    m_front = 1 - m_front;
+    m_vertices_count = pending->count;
+    m_ordered_count = pending->count;
+    m_order_stride = pending->order_stride;
+    m_order_inverse = pending->order_inverse;
+    m_depth_factor = pending->depth_factor;
+    m_has_normals = pending->has_normals;
+    m_use_indices = false;
+    return true;
+}
+
+// Superseded by a newer upload, the job stops at its next slice and is collected by poll_points(...)
+void GLPointCloudObject::abandon_points()
+{
+    if (nullptr == m_pending)
+        return;
+    m_pending->transfer->cancel = true;
+    m_abandoned.emplace_back(std::move(m_pending));
+}
+
+/*!
+ * \brief GLPointCloudObject::cancel_points
+ * Stops the uploads in progress and waits for their jobs, after which the vertex data they were
+ * reading can be modified. May be called without any current context.
+ */
+void GLPointCloudObject::cancel_points(GLBufferUploader& uploader)
+{
+    abandon_points();
+    for (const std::shared_ptr<PendingPoints>& pending : m_abandoned) {
+        uploader.cancel(*pending->transfer);
+        release_points(uploader, pending);
+    }
+    m_abandoned.clear();
+}
+
+// The buffers of a job that was not swapped in, destroyed by the uploader thread which has a context current
+void GLPointCloudObject::release_points(GLBufferUploader& uploader, const std::shared_ptr<PendingPoints>& pending)
+{
+    if (pending->transfer->result.valid())
+        pending->transfer->result.wait();
+    uploader.submit([pending](GLBufferUploader&, const std::atomic<bool>&) {
+        pending->buffers = VertexBuffers();
+        return true;
+    });
+}
+
+/*!
+ * \brief GLPointCloudObject::set_indices
+ * Draws only the listed points, e.g. the ones kept by the outlier filter, without uploading them
+ * again. Reset by set_points(...) and upload_frame(...).
+ * \param point_indices of the points given to set_points(...), below vertices_count(), empty draws every vertex
+ */
+void GLPointCloudObject::set_indices(const std::vector<std::uint32_t>& point_indices)
+{
+    if (!m_initialized || point_indices.empty()) {
+        m_use_indices = false;
+        return;
+    }
+
+    // Mapped to the draw order and sorted by marking, so that a budget draws an even prefix as well
+    std::vector<std::uint8_t> marks(m_vertices_count, 0);
+    for (const std::uint32_t i : point_indices) {
+        const std::size_t j = i < m_ordered_count ? static_cast<std::size_t>((i * m_order_inverse) % m_ordered_count) : i;
+        if (j < marks.size())
+            marks[j] = 1;
+    }
+    std::vector<std::uint32_t> indices;
+    indices.reserve(point_indices.size());
+    for (std::size_t j=0; j<marks.size(); j++) {
+        if (marks[j])
+            indices.emplace_back(static_cast<std::uint32_t>(j));
+    }
+
+    if (!m_index_buffer) {
+        m_index_buffer = std::make_unique<QOpenGLBuffer>(QOpenGLBuffer::IndexBuffer);
+        m_index_buffer->create();
+        m_index_buffer->setUsagePattern(QOpenGLBuffer::StaticDraw);
+    }
+    m_index_buffer->bind();
+    m_index_buffer->allocate(indices.data(), static_cast<int>(indices.size() * sizeof (std::uint32_t)));
+    m_index_buffer->release();
+
+    m_index_count = indices.size();
+    m_use_indices = true;
+}
+
+/*!
+ * \brief GLPointCloudObject::append_points
+ * Writes the points behind the ones already uploaded, nothing else is uploaded again.
+ * \return false if the spare capacity is too small, the caller has to set_points(...) again with more room
+ */
+bool GLPointCloudObject::append_points(const graphics::VertexData &appended)
+{
+    const std::size_t count = appended.positions.size();
+    if (0 == count)
+        return true;
+
+    VertexBuffers& front = m_buffers[m_front];
+    if (!m_initialized || !front.vao || front.rgba8 || m_vertices_count + count > front.capacity)
+        return false;
+
+    front.position->bind();
+    if (m_x_inversion || m_y_inversion || m_z_inversion) {
+        const std::vector<QVector3D> positions = transform_positions(appended.positions);
+        front.position->write(static_cast<int>(m_vertices_count * sizeof (QVector3D)), positions.data(), static_cast<int>(count * sizeof (QVector3D)));
+    } else {
+        front.position->write(static_cast<int>(m_vertices_count * sizeof (QVector3D)), appended.positions.data(), static_cast<int>(count * sizeof (QVector3D)));
+    }
+    front.position->release();
+
+    front.color->bind();
+    if (appended.colors.size() == count && m_use_original_colors) {
+        front.color->write(static_cast<int>(m_vertices_count * sizeof (QVector4D)), appended.colors.data(), static_cast<int>(count * sizeof (QVector4D)));
+    } else {
+        const std::vector<QVector4D> colors = compute_colors_from_depth(appended.positions, m_depth_factor, m_pc_encoding, m_inverse_depth_colors);
+        front.color->write(static_cast<int>(m_vertices_count * sizeof (QVector4D)), colors.data(), static_cast<int>(count * sizeof (QVector4D)));
+    }
+    front.color->release();
+
+    if (m_has_normals && appended.normals.size() == count) {
+        front.normal->bind();
+        if (m_x_inversion || m_y_inversion || m_z_inversion) {
+            const std::vector<QVector3D> normals = transform_positions(appended.normals);
+            front.normal->write(static_cast<int>(m_vertices_count * sizeof (QVector3D)), normals.data(), static_cast<int>(count * sizeof (QVector3D)));
         } else {
-            vbo_color->allocate(vertex_data.colors.data(), static_cast<int>(vertex_data.colors.size() * sizeof (QVector4D))); // allocate with writing
+            front.normal->write(static_cast<int>(m_vertices_count * sizeof (QVector3D)), appended.normals.data(), static_cast<int>(count * sizeof (QVector3D)));
         }
-        m_shader->setAttributeBuffer("vertex_color", GL_FLOAT, 0, 4);
-        m_shader->enableAttributeArray("vertex_color");
-        vbo_color->release();
+        front.normal->release();
+    } else {
+        m_has_normals = false;
+    }
+
+    m_vertices_count += count;
+    return true;
+}
 
-    m_vao->release();
+/*!
+ * \brief GLPointCloudObject::upload_frame
+ * Uploads positions (x, y, z float) and RGBA8 colors straight from client memory, e.g. a mapped
+ * shared-memory slot, into the back buffers. The buffers are swapped only if is_intact() confirms
+ * that the memory was not modified during the upload. Inversions of the axes are not applied.
+ * \param colors_rgba8 nullptr draws the points white
+ * \return false if the frame was dropped
+ */
+bool GLPointCloudObject::upload_frame(const float* positions, const std::uint8_t* colors_rgba8, const std::size_t count,
+                                      const std::function<bool()>& is_intact)
+{
+    if (!m_initialized || nullptr == m_shader)
+        return false;
+
+    abandon_points();
+    m_shader->bind();
+    VertexBuffers& back = m_buffers[1 - m_front];
+    if (!back.vao || !back.rgba8 || back.capacity < count || back.capacity > 2 * count)
+        create_buffers(back, count, QOpenGLBuffer::StreamDraw, true);
+
+    if (nullptr == colors_rgba8) {
+        if (m_white_rgba8.size() < count * 4)
+            m_white_rgba8.assign(count * 4, 255);
+        colors_rgba8 = m_white_rgba8.data();
+    }
+
+    // glBufferSubData copies the client memory before it returns
+    back.position->bind();
+    back.position->write(0, positions, static_cast<int>(count * 3 * sizeof (float)));
+    back.position->release();
+    back.color->bind();
+    back.color->write(0, colors_rgba8, static_cast<int>(count * 4));
+    back.color->release();
     m_shader->release();
 
-    m_initialized = true;
+    if (is_intact && !is_intact())
+        return false;
+
+    m_front = 1 - m_front;
+    m_vertices_count = count;
+    m_ordered_count = 0;
+    m_has_normals = false;
+    m_use_indices = false;
+    return true;
 }
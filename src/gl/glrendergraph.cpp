@@ -0,0 +1,192 @@
+#include "glrendergraph.h"
+
+#include <chrono>
+#include <algorithm>
+
+void GLRenderGraph::initialize_gl()
+{
+    // Every pass gets its own queries, GL_TIME_ELAPSED queries can not be nested
+    GLFrameTimer probe;
+    probe.initialize_gl();
+    m_gpu_timers = probe.is_supported();
+    probe.destroy();
+
+    for (Pass& pass : m_passes) {
+        if (m_gpu_timers && !pass.timer) {
+            pass.timer = std::make_unique<GLFrameTimer>();
+            pass.timer->initialize_gl();
+        }
+    }
+}
+
+void GLRenderGraph::clear()
+{
+    m_passes.clear();
+    m_order.clear();
+    m_current_state.reset();
+}
+
+GLRenderGraph::Pass& GLRenderGraph::add_pass(const std::string& name, const std::optional<GLRenderState>& state, const std::vector<std::string>& inputs,
+                                             std::function<void()> execute, std::function<bool()> is_active)
+{
+    Pass pass;
+    pass.name = name;
+    pass.state = state;
+    pass.inputs = inputs;
+    pass.execute = std::move(execute);
+    pass.is_active = std::move(is_active);
+    if (m_gpu_timers) {
+        pass.timer = std::make_unique<GLFrameTimer>();
+        pass.timer->initialize_gl();
+    }
+    m_passes.emplace_back(std::move(pass));
+    m_order.clear();
+    return m_passes.back();
+}
+
+bool GLRenderGraph::set_enabled(const std::string& name, const bool enabled)
+{
+    for (Pass& pass : m_passes) {
+        if (pass.name == name) {
+            pass.enabled = enabled;
+            return true;
+        }
+    }
+    return false;
+}
+
+const GLRenderGraph::Pass* GLRenderGraph::find(const std::string& name) const
+{
+    for (const Pass& pass : m_passes) {
+        if (pass.name == name)
+            return &pass;
+    }
+    return nullptr;
+}
+
+double GLRenderGraph::gpu_time() const
+{
+    double time = 0.;
+    for (const Pass& pass : m_passes) {
+        if (pass.executed && pass.timer)
+            time += pass.timer->gpu_time();
+    }
+    return time;
+}
+
+/*!
+ * \brief GLRenderGraph::schedule
+ * Topological order of the passes that will run this frame. Among the passes whose inputs are
+ * done, the first declared one with the state of the previous pass (or no state) is taken,
+ * otherwise the first declared one. Inputs that are unknown, disabled or inactive count as done.
+ */
+void GLRenderGraph::schedule()
+{
+    const std::size_t count = m_passes.size();
+    std::vector<bool> done(count, false);
+    std::vector<bool> runs(count, false);
+    for (std::size_t i=0; i<count; i++)
+        runs[i] = m_passes[i].enabled && (!m_passes[i].is_active || m_passes[i].is_active());
+
+    auto is_ready = [&](const std::size_t i) {
+        for (const std::string& input : m_passes[i].inputs) {
+            for (std::size_t j=0; j<count; j++) {
+                if (m_passes[j].name == input && !done[j])
+                    return false;
+            }
+        }
+        return true;
+    };
+
+    m_order.clear();
+    std::optional<GLRenderState> state = m_current_state;
+    while (m_order.size() < count) {
+        std::size_t chosen = count;
+        for (std::size_t i=0; i<count; i++) {
+            if (done[i] || !is_ready(i))
+                continue;
+            if (count == chosen)
+                chosen = i;
+            // Passes that do not run or do not draw never change the state
+            if (!runs[i] || !m_passes[i].state || (state && *state == *m_passes[i].state)) {
+                chosen = i;
+                break;
+            }
+        }
+        if (count == chosen) {
+            std::cerr << "GLRenderGraph: the inputs of the passes form a cycle, running the rest in declaration order\n";
+            for (std::size_t i=0; i<count; i++) {
+                if (!done[i])
+                    m_order.push_back(i);
+            }
+            break;
+        }
+
+        done[chosen] = true;
+        m_order.push_back(chosen);
+        if (runs[chosen] && m_passes[chosen].state)
+            state = m_passes[chosen].state;
+    }
+
+    for (std::size_t i=0; i<count; i++)
+        m_passes[i].executed = runs[i];
+}
+
+void GLRenderGraph::apply(const GLRenderState& state)
+{
+    QOpenGLFunctions* f = QOpenGLContext::currentContext()->functions();
+    const bool known = m_current_state.has_value();
+    bool changed = false;
+
+    if (!known || m_current_state->depth_test != state.depth_test) {
+        state.depth_test ? f->glEnable(GL_DEPTH_TEST) : f->glDisable(GL_DEPTH_TEST);
+        changed = true;
+    }
+    if (!known || m_current_state->depth_func != state.depth_func) {
+        f->glDepthFunc(state.depth_func);
+        changed = true;
+    }
+    if (!known || m_current_state->depth_write != state.depth_write) {
+        f->glDepthMask(state.depth_write ? GL_TRUE : GL_FALSE);
+        changed = true;
+    }
+    if (!known || m_current_state->blend != state.blend) {
+        state.blend ? f->glEnable(GL_BLEND) : f->glDisable(GL_BLEND);
+        changed = true;
+    }
+    if (!known)
+        f->glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    m_state_changes += changed ? 1 : 0;
+    m_current_state = state;
+}
+
+void GLRenderGraph::execute()
+{
+    // Anything may have been drawn between two frames, the overlay for one
+    m_current_state.reset();
+    m_state_changes = 0;
+    schedule();
+
+    for (const std::size_t i : m_order) {
+        Pass& pass = m_passes[i];
+        if (!pass.executed)
+            continue;
+
+        const auto start = std::chrono::steady_clock::now();
+        if (pass.timer)
+            pass.timer->begin();
+        if (pass.state)
+            apply(*pass.state);
+        pass.execute();
+        if (pass.timer)
+            pass.timer->end();
+        pass.cpu_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Left as the overlay painting expects it, depth writes on for the next clear
+    QOpenGLFunctions* f = QOpenGLContext::currentContext()->functions();
+    f->glDepthMask(GL_TRUE);
+    f->glDisable(GL_DEPTH_TEST);
+    m_current_state.reset();
+}
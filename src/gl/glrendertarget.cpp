@@ -0,0 +1,121 @@
+#include "glrendertarget.h"
+
+#include <cmath>
+#include <algorithm>
+
+#ifndef GL_DEPTH_COMPONENT24
+#define GL_DEPTH_COMPONENT24 0x81A6
+#endif
+
+GLRenderTarget::~GLRenderTarget()
+{
+    // The textures go with the context otherwise
+    if (nullptr != QOpenGLContext::currentContext())
+        destroy();
+}
+
+void GLRenderTarget::destroy()
+{
+    QOpenGLFunctions* f = QOpenGLContext::currentContext()->functions();
+    if (0 != m_framebuffer)
+        f->glDeleteFramebuffers(1, &m_framebuffer);
+    if (0 != m_color_texture)
+        f->glDeleteTextures(1, &m_color_texture);
+    if (0 != m_depth_texture)
+        f->glDeleteTextures(1, &m_depth_texture);
+
+    m_framebuffer = 0;
+    m_color_texture = 0;
+    m_depth_texture = 0;
+    m_width = 0;
+    m_height = 0;
+    m_viewport_width = 0;
+    m_viewport_height = 0;
+}
+
+/*!
+ * \brief GLRenderTarget::resize
+ * (Re)creates the textures when the size changes, nothing is done otherwise.
+ * \return false if the framebuffer is not complete, the target is left empty
+ */
+bool GLRenderTarget::resize(const int width, const int height)
+{
+    if (width <= 0 || height <= 0)
+        return false;
+    if (is_valid() && width == m_width && height == m_height)
+        return true;
+
+    destroy();
+    QOpenGLFunctions* f = QOpenGLContext::currentContext()->functions();
+
+    auto create_texture = [f, width, height](const GLint internal_format, const GLenum format, const GLenum type) {
+        GLuint texture = 0;
+        f->glGenTextures(1, &texture);
+        f->glBindTexture(GL_TEXTURE_2D, texture);
+        f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        f->glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, type, nullptr);
+        return texture;
+    };
+    m_color_texture = create_texture(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+    m_depth_texture = create_texture(GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT);
+    f->glBindTexture(GL_TEXTURE_2D, 0);
+
+    GLint previous_framebuffer = 0;
+    f->glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous_framebuffer);
+    f->glGenFramebuffers(1, &m_framebuffer);
+    f->glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    f->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_color_texture, 0);
+    f->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depth_texture, 0);
+    const GLenum status = f->glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    f->glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(previous_framebuffer));
+
+    if (GL_FRAMEBUFFER_COMPLETE != status) {
+        std::cerr << "GLRenderTarget::resize framebuffer of " << width << "x" << height << " is not complete (0x" << std::hex << status << std::dec << ")\n";
+        destroy();
+        return false;
+    }
+
+    m_width = width;
+    m_height = height;
+    return true;
+}
+
+void GLRenderTarget::bind(const float scale)
+{
+    // A smaller viewport instead of smaller textures, the scale can change every frame
+    m_viewport_width = std::clamp(static_cast<int>(std::lround(static_cast<float>(m_width) * scale)), 1, m_width);
+    m_viewport_height = std::clamp(static_cast<int>(std::lround(static_cast<float>(m_height) * scale)), 1, m_height);
+
+    QOpenGLFunctions* f = QOpenGLContext::currentContext()->functions();
+    f->glGetIntegerv(GL_FRAMEBUFFER_BINDING, &m_previous_framebuffer);
+    f->glGetIntegerv(GL_VIEWPORT, m_previous_viewport);
+    f->glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    f->glViewport(0, 0, m_viewport_width, m_viewport_height);
+}
+
+void GLRenderTarget::release()
+{
+    QOpenGLFunctions* f = QOpenGLContext::currentContext()->functions();
+    f->glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(m_previous_framebuffer));
+    f->glViewport(m_previous_viewport[0], m_previous_viewport[1], m_previous_viewport[2], m_previous_viewport[3]);
+}
+
+bool GLRenderTarget::upload(const std::uint32_t* colors, const float* depths, const int width, const int height)
+{
+    if (!is_valid() || width <= 0 || height <= 0 || width > m_width || height > m_height)
+        return false;
+    m_viewport_width = width;
+    m_viewport_height = height;
+
+    // Rows of 4 bytes per texel, the default unpack alignment holds
+    QOpenGLFunctions* f = QOpenGLContext::currentContext()->functions();
+    f->glBindTexture(GL_TEXTURE_2D, m_color_texture);
+    f->glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_viewport_width, m_viewport_height, GL_RGBA, GL_UNSIGNED_BYTE, colors);
+    f->glBindTexture(GL_TEXTURE_2D, m_depth_texture);
+    f->glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_viewport_width, m_viewport_height, GL_DEPTH_COMPONENT, GL_FLOAT, depths);
+    f->glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
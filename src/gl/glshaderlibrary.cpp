@@ -0,0 +1,221 @@
+#include "glshaderlibrary.h"
+
+#include <plyloader.h> // manual_timer
+
+namespace {
+
+const char* const lines_vertex_source =
+        "in vec3 vertex_position;\n"
+        "in vec4 vertex_color;\n"
+        "in vec4 main_color;\n"
+        "out vec4 color;\n"
+        "uniform mat4 model_matrix;\n"
+        "void main(void)\n"
+        "{\n"
+        "    gl_Position = view_projection_matrix * (model_matrix * vec4(vertex_position, 1.0F));\n"
+        "    color = vertex_color * main_color;\n"
+        "}\n";
+
+const char* const lines_fragment_source =
+        "in vec4 color;\n"
+        "out vec4 frag_color;\n"
+        "void main(void)\n"
+        "{\n"
+        "    frag_color = color;\n"
+        "}\n";
+
+// Point sizes are focus_distance / depth times point_size with SIZE_ATTENUATION, so that points
+// grow when getting closer like a surface. The lighting is two-sided, estimated normals may face away.
+const char* const points_vertex_source =
+        "in vec3 vertex_position;\n"
+        "in vec4 vertex_color;\n"
+        "out vec4 color;\n"
+        "uniform mat4 model_matrix;\n"
+        "uniform float point_size;\n"
+        "#ifdef SHADING\n"
+        "in vec3 vertex_normal;\n"
+        "out vec3 normal;\n"
+        "uniform mat3 normal_matrix;\n"
+        "#endif\n"
+        "#ifdef SIZE_ATTENUATION\n"
+        "uniform float focus_distance;\n"
+        "#endif\n"
+        "void main(void)\n"
+        "{\n"
+        "    vec4 view_position = view_matrix * (model_matrix * vec4(vertex_position, 1.0));\n"
+        "    gl_Position = projection_matrix * view_position;\n"
+        "#ifdef SIZE_ATTENUATION\n"
+        "    gl_PointSize = clamp(point_size * focus_distance / max(-view_position.z, 0.001), 1.0, 64.0);\n"
+        "#else\n"
+        "    gl_PointSize = clamp(point_size, 1.0, 64.0);\n"
+        "#endif\n"
+        "    color = vertex_color;\n"
+        "#ifdef SHADING\n"
+        "    normal = normal_matrix * vertex_normal;\n"
+        "#endif\n"
+        "}\n";
+
+const char* const points_fragment_source =
+        "in vec4 color;\n"
+        "out vec4 frag_color;\n"
+        "#ifdef SHADING\n"
+        "in vec3 normal;\n"
+        "#endif\n"
+        "void main(void)\n"
+        "{\n"
+        "    vec2 coord = 2.0 * gl_PointCoord - 1.0;\n"
+        "    if (dot(coord, coord) > 1.0)\n"
+        "        discard;\n"
+        "#ifdef SHADING\n"
+        "    float light = dot(normal, normal) > 0.0 ? 0.3 + 0.7 * abs(normalize(normal).z) : 1.0;\n"
+        "    frag_color = vec4(color.rgb * light, color.a);\n"
+        "#else\n"
+        "    frag_color = color;\n"
+        "#endif\n"
+        "}\n";
+
+// Full-screen triangle from gl_VertexID, sampling the drawn part (uv_scale) of the target. With
+// EYE_DOME the response of a pixel is the mean of how much farther it is than its 8 neighbours in
+// log2 of the linear depth, the colour is scaled by exp(-300 * strength * response). Background
+// pixels (depth 1) are discarded.
+const char* const composite_vertex_source =
+        "out vec2 uv;\n"
+        "void main(void)\n"
+        "{\n"
+        "    uv = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);\n"
+        "    gl_Position = vec4(2.0 * uv - 1.0, 0.0, 1.0);\n"
+        "}\n";
+
+const char* const composite_fragment_source =
+        "in vec2 uv;\n"
+        "out vec4 frag_color;\n"
+        "uniform sampler2D color_texture;\n"
+        "uniform sampler2D depth_texture;\n"
+        "uniform vec2 uv_scale;\n"
+        "#ifdef EYE_DOME\n"
+        "uniform vec2 texel_size;\n"
+        "uniform float radius;\n"
+        "uniform float strength;\n"
+        "uniform float near_plane;\n"
+        "uniform float far_plane;\n"
+        "uniform bool perspective;\n"
+        "const vec2 neighbours[8] = vec2[8](vec2(1.0, 0.0), vec2(-1.0, 0.0), vec2(0.0, 1.0), vec2(0.0, -1.0),\n"
+        "                                   vec2(0.707, 0.707), vec2(-0.707, 0.707), vec2(0.707, -0.707), vec2(-0.707, -0.707));\n"
+        "float log_depth(float d)\n"
+        "{\n"
+        "    float z = perspective ? near_plane * far_plane / (far_plane - d * (far_plane - near_plane)) : 1.0 + d;\n"
+        "    return log2(z);\n"
+        "}\n"
+        "#endif\n"
+        "void main(void)\n"
+        "{\n"
+        "    vec2 position = uv * uv_scale;\n"
+        "    float d = texture(depth_texture, position).r;\n"
+        "    if (d >= 1.0)\n"
+        "        discard;\n"
+        "    float shade = 1.0;\n"
+        "#ifdef EYE_DOME\n"
+        "    float center = log_depth(d);\n"
+        "    float response = 0.0;\n"
+        "    vec2 last = uv_scale - 0.5 * texel_size;\n"
+        "    for (int i = 0; i < 8; i++)\n"
+        "        response += max(0.0, center - log_depth(texture(depth_texture, min(position + radius * texel_size * neighbours[i], last)).r));\n"
+        "    shade = exp(-300.0 * strength * response / 8.0);\n"
+        "#endif\n"
+        "    vec4 color = texture(color_texture, position);\n"
+        "    frag_color = vec4(color.rgb * shade, color.a);\n"
+        "    gl_FragDepth = d;\n"
+        "}\n";
+
+// Features each program is specialized on, the others are ignored
+unsigned program_features(const GLShaderLibrary::Program type)
+{
+    switch (type) {
+    case GLShaderLibrary::points:
+        return GLShaderLibrary::shading | GLShaderLibrary::size_attenuation;
+    case GLShaderLibrary::composite:
+        return GLShaderLibrary::eye_dome;
+    default:
+        return GLShaderLibrary::no_feature;
+    }
+}
+
+}
+
+GLShaderLibrary::~GLShaderLibrary()
+{
+    if (nullptr != QOpenGLContext::currentContext())
+        destroy();
+}
+
+void GLShaderLibrary::initialize_gl(GLCameraUniforms* camera_uniforms)
+{
+    destroy();
+    m_camera_uniforms = camera_uniforms;
+}
+
+void GLShaderLibrary::destroy()
+{
+    m_programs.clear();
+    m_build_time = 0.;
+}
+
+QOpenGLShaderProgram* GLShaderLibrary::program(const Program type, const unsigned features)
+{
+    const std::pair<Program, unsigned> key(type, features & program_features(type));
+    auto it = m_programs.find(key);
+    if (m_programs.end() == it)
+        it = m_programs.emplace(key, build(key.first, key.second)).first;
+    return it->second.get();
+}
+
+std::unique_ptr<QOpenGLShaderProgram> GLShaderLibrary::build(const Program type, const unsigned features)
+{
+    graphics::manual_timer timer;
+    timer.start();
+
+    QByteArray defines;
+    if (features & shading)
+        defines += "#define SHADING\n";
+    if (features & size_attenuation)
+        defines += "#define SIZE_ATTENUATION\n";
+    if (features & eye_dome)
+        defines += "#define EYE_DOME\n";
+
+    // The camera matrices come with the #version line, the full-screen pass needs none of them
+    const QByteArray camera_header = nullptr != m_camera_uniforms ? m_camera_uniforms->shader_header() : QByteArray("#version 130\n");
+    const QByteArray version("#version 130\n");
+    const char* names[] = {"lines", "points", "composite"};
+
+    std::unique_ptr<QOpenGLShaderProgram> shader = std::make_unique<QOpenGLShaderProgram>();
+    switch (type) {
+    case lines:
+        shader->addCacheableShaderFromSourceCode(QOpenGLShader::Vertex, camera_header + defines + lines_vertex_source);
+        shader->addCacheableShaderFromSourceCode(QOpenGLShader::Fragment, version + defines + lines_fragment_source);
+        break;
+    case points:
+        shader->addCacheableShaderFromSourceCode(QOpenGLShader::Vertex, camera_header + defines + points_vertex_source);
+        shader->addCacheableShaderFromSourceCode(QOpenGLShader::Fragment, version + defines + points_fragment_source);
+        break;
+    case composite:
+        shader->addCacheableShaderFromSourceCode(QOpenGLShader::Vertex, version + defines + composite_vertex_source);
+        shader->addCacheableShaderFromSourceCode(QOpenGLShader::Fragment, version + defines + composite_fragment_source);
+        break;
+    }
+    shader->bindAttributeLocation("vertex_position", position_location);
+    shader->bindAttributeLocation("vertex_color", color_location);
+    shader->bindAttributeLocation("vertex_normal", normal_location);
+    shader->bindAttributeLocation("main_color", main_color_location);
+    shader->link();
+
+    if (!shader->isLinked()) {
+        std::cerr << "Error: " << names[type] << " shader (features " << features << ") is not linked" << std::endl;
+    } else if (nullptr != m_camera_uniforms && composite != type) {
+        m_camera_uniforms->attach(shader.get());
+    }
+
+    timer.stop();
+    m_build_time += timer.get();
+    std::cout << "Shader " << names[type] << " (features " << features << ") built in " << timer.get() << " ms" << std::endl;
+    return shader;
+}
@@ -6,6 +6,8 @@
 #include <QLabel>
 #include <QApplication>
 #include <QDesktopWidget>
+#include <QSignalBlocker>
+#include <QInputDialog>
 
 #include <vector>
 //#include <ranges>
@@ -23,11 +25,20 @@ MainWindow::MainWindow()
     setWindowTitle(m_title);
     setMinimumSize(600, 400);
 
+    // take the first command line argument that is not an option as a path to PLY files
+    QString ply_path;
+    const QStringList arguments = QApplication::arguments();
+    for (int i=1; i<arguments.size(); i++) {
+        if ("--software" == arguments[i])
+            m_software_rendering = true;
+        else if (ply_path.isEmpty())
+            ply_path = arguments[i];
+    }
+
     create_menu_bar();
 
-    // take first command line argument as a path to PLY files
-    if (QApplication::arguments().size() > 1) {
-        open_view(QApplication::arguments()[1]);
+    if (!ply_path.isEmpty()) {
+        open_view(ply_path);
     } else {
         // place some hints on a screen
         auto welcomeHint = new QLabel();
@@ -37,7 +48,7 @@ MainWindow::MainWindow()
         t += "<p />";
         t += "<ul>";
         t += "<li>Use menu <b>File</b> -> <b>Open</b> to load PLY file</li>";
-        t += "<li>Use with command line: ./pointcloudviewer your_cloud.ply</li>";
+        t += "<li>Use with command line: ./pointcloudviewer [--software] your_cloud.ply</li>";
         t += "<li><h2>Navigation hints</h2></li>";
         t += "<ul>";
         t += "<li>Use mouse to rotate camera</li>";
@@ -73,6 +84,35 @@ void MainWindow::create_menu_bar()
     QAction *openFile = new QAction(tr("&Open"), fileMenu);
     fileMenu->addAction(openFile);
     connect(openFile, &QAction::triggered, this, &MainWindow::open_file_dialog);
+    QAction *openLibrary = new QAction(tr("Open &Library..."), fileMenu);
+    fileMenu->addAction(openLibrary);
+    connect(openLibrary, &QAction::triggered, this, &MainWindow::create_library_dialog);
+    QAction *openSequence = new QAction(tr("Open &Sequence..."), fileMenu);
+    fileMenu->addAction(openSequence);
+    connect(openSequence, &QAction::triggered, this, &MainWindow::open_sequence_dialog);
+    QAction *openDepthImage = new QAction(tr("Open &Depth Image..."), fileMenu);
+    fileMenu->addAction(openDepthImage);
+    connect(openDepthImage, &QAction::triggered, this, &MainWindow::open_depth_image_dialog);
+    QAction *openDepthSequence = new QAction(tr("Open Depth Se&quence..."), fileMenu);
+    fileMenu->addAction(openDepthSequence);
+    connect(openDepthSequence, &QAction::triggered, this, &MainWindow::open_depth_sequence_dialog);
+    QAction *exportFile = new QAction(tr("&Export PLY..."), fileMenu);
+    fileMenu->addAction(exportFile);
+    connect(exportFile, &QAction::triggered, this, &MainWindow::export_file_dialog);
+    m_follow_action = new QAction(tr("&Follow File"), fileMenu);
+    m_follow_action->setCheckable(true);
+    fileMenu->addAction(m_follow_action);
+    connect(m_follow_action, &QAction::toggled, this, &MainWindow::follow_file);
+#ifdef Q_OS_LINUX
+    m_stream_action = new QAction(tr("Listen for &Stream..."), fileMenu);
+    m_stream_action->setCheckable(true);
+    fileMenu->addAction(m_stream_action);
+    connect(m_stream_action, &QAction::toggled, this, &MainWindow::listen_stream);
+    m_ring_action = new QAction(tr("Attach Shared &Memory Ring..."), fileMenu);
+    m_ring_action->setCheckable(true);
+    fileMenu->addAction(m_ring_action);
+    connect(m_ring_action, &QAction::toggled, this, &MainWindow::attach_shared_ring);
+#endif
     QAction *actionResetView = new QAction(tr("&Reset Camera View"), this);
     fileMenu->addAction(actionResetView);
     connect(actionResetView, &QAction::triggered, this, &MainWindow::reset_camera_view);
@@ -89,6 +129,25 @@ void MainWindow::create_menu_bar()
     settingsMenu->addAction(point_cloud_control);
     connect(point_cloud_control, &QAction::triggered, this, &MainWindow::create_pc_control_dialog);
 
+    QAction *stats_overlay = new QAction(tr("Show &Stats Overlay"), fileMenu);
+    stats_overlay->setCheckable(true);
+    stats_overlay->setChecked(true);
+    settingsMenu->addAction(stats_overlay);
+    connect(stats_overlay, &QAction::toggled, this, [this](bool checked) {
+        if (m_gl_window)
+            m_gl_window->m_draw_stats = checked;
+    });
+
+    QAction *software_rendering = new QAction(tr("S&oftware Rendering"), fileMenu);
+    software_rendering->setCheckable(true);
+    software_rendering->setChecked(m_software_rendering);
+    settingsMenu->addAction(software_rendering);
+    connect(software_rendering, &QAction::toggled, this, [this](bool checked) {
+        m_software_rendering = checked;
+        if (m_gl_window)
+            m_gl_window->set_software_rendering(checked);
+    });
+
     QMenu *helpMenu = menuBar->addMenu(tr("&Help"));
     QAction *aboutDialog = new QAction(tr("&About"), helpMenu);
     helpMenu->addAction(aboutDialog);
@@ -112,7 +171,36 @@ void MainWindow::open_file_dialog()
     }
 }
 
-void MainWindow::open_view(const QString& ply_path)
+void MainWindow::export_file_dialog()
+{
+    if (!m_gl_window)
+        return;
+
+    m_gl_window->stop_rendering();
+
+    QString selected_filter;
+    const QString filePath = QFileDialog::getSaveFileName(this, tr("Export PLY file"), "../resources/pointclouds/",
+                                                          tr("Binary PLY (*.ply);;ASCII PLY (*.ply)"), &selected_filter);
+    qDebug() << "Export:" << filePath;
+
+    if (!filePath.isEmpty() && !m_gl_window->export_ply(filePath.toStdString(), selected_filter.startsWith("Binary"))) {
+        QMessageBox::warning(this, tr("Export PLY file"), tr("Could not write %1").arg(filePath));
+    }
+
+    m_gl_window->start_rendering();
+}
+
+void MainWindow::follow_file(bool checked)
+{
+    if (!m_gl_window || (!m_gl_window->follow_file(checked) && checked)) {
+        const QSignalBlocker blocker(m_follow_action);
+        m_follow_action->setChecked(false);
+        if (checked)
+            QMessageBox::warning(this, tr("Follow File"), tr("Only binary little endian PLY files with the vertex element last can be followed."));
+    }
+}
+
+void MainWindow::create_view()
 {
     // create new widget
     if (!m_gl_window) {
@@ -120,11 +208,172 @@ void MainWindow::open_view(const QString& ply_path)
         setCentralWidget(QWidget::createWindowContainer(m_gl_window.get(), this));
         const QRect desk = QApplication::desktop()->availableGeometry(QApplication::desktop()->screenNumber(this));
         m_gl_window->resize(static_cast<int>(desk.width() * .8f), static_cast<int>(desk.height() * .8f));
+        m_gl_window->set_software_rendering(m_software_rendering);
+    }
+}
+
+void MainWindow::listen_stream(bool checked)
+{
+    if (!checked) {
+        if (m_gl_window)
+            m_gl_window->stop_stream();
+        return;
+    }
+
+    bool accepted = false;
+    const QString address = QInputDialog::getText(this, tr("Listen for Stream"), tr("Address (unix:/path or tcp:PORT):"),
+                                                  QLineEdit::Normal, "unix:/tmp/qt-pc-viewer.sock", &accepted);
+    create_view();
+    const bool listening = accepted && !address.isEmpty() && m_gl_window->listen_stream(address.toStdString());
+    uncheck_live_inputs(m_stream_action);
+    if (!listening) {
+        const QSignalBlocker blocker(m_stream_action);
+        m_stream_action->setChecked(false);
+        if (accepted)
+            QMessageBox::warning(this, tr("Listen for Stream"), tr("Could not listen on %1").arg(address));
+    }
+}
+
+void MainWindow::attach_shared_ring(bool checked)
+{
+    if (!checked) {
+        if (m_gl_window)
+            m_gl_window->detach_shared_ring();
+        return;
+    }
+
+#ifdef Q_OS_LINUX
+    const char* default_name = graphics::PointRing::default_name;
+#else
+    const char* default_name = "";
+#endif
+    bool accepted = false;
+    const QString name = QInputDialog::getText(this, tr("Attach Shared Memory Ring"), tr("Shared memory name:"),
+                                               QLineEdit::Normal, default_name, &accepted);
+    create_view();
+    const bool attached = accepted && !name.isEmpty() && m_gl_window->attach_shared_ring(name.toStdString());
+    uncheck_live_inputs(m_ring_action);
+    if (!attached) {
+        const QSignalBlocker blocker(m_ring_action);
+        m_ring_action->setChecked(false);
+        if (accepted)
+            QMessageBox::warning(this, tr("Attach Shared Memory Ring"), tr("No point ring %1, start the producer first").arg(name));
     }
+}
+
+void MainWindow::uncheck_live_inputs(QAction* except)
+{
+    // The actions of the inputs a platform lacks are not created
+    for (QAction* action : {m_follow_action, m_stream_action, m_ring_action}) {
+        if (nullptr != action && action != except) {
+            const QSignalBlocker blocker(action);
+            action->setChecked(false);
+        }
+    }
+}
+
+void MainWindow::open_view(const QString& ply_path)
+{
+    create_view();
     m_gl_window->open_ply(ply_path.toStdString());
+
+    uncheck_live_inputs(); // open_ply(...) stops all of them
 }
 
 
+void MainWindow::open_sequence_dialog()
+{
+    if (m_gl_window)
+        m_gl_window->stop_rendering();
+
+    const QString directory = QFileDialog::getExistingDirectory(this, tr("Open frame sequence directory"), "../resources/pointclouds/");
+    qDebug() << "Open sequence:" << directory;
+
+    if (!directory.isEmpty()) {
+        create_view();
+        if (m_gl_window->open_sequence(directory.toStdString())) {
+            uncheck_live_inputs();
+            create_sequence_dialog();
+        } else {
+            QMessageBox::warning(this, tr("Open Sequence"), tr("No PLY frames in %1").arg(directory));
+        }
+    }
+
+    if (m_gl_window){
+        m_gl_window->start_rendering();
+    }
+}
+
+/*!
+ * \brief MainWindow::find_intrinsics
+ * Reads the intrinsics.txt found next to path, or asks for the intrinsics if there is none.
+ */
+bool MainWindow::find_intrinsics(const QString& path, graphics::CameraIntrinsics& intrinsics)
+{
+    const std::string intrinsics_file = graphics::find_intrinsics_file(path.toStdString());
+    if (!intrinsics_file.empty() && graphics::read_intrinsics(intrinsics_file, intrinsics))
+        return true;
+
+    bool accepted = false;
+    const QString text = QInputDialog::getText(this, tr("Camera Intrinsics"), tr("No intrinsics.txt found, fx fy cx cy [depth_scale [max_depth]]:"),
+                                               QLineEdit::Normal, "525 525 319.5 239.5 0.001", &accepted);
+    if (!accepted)
+        return false;
+
+    if (!graphics::parse_intrinsics(text.toStdString(), intrinsics)) {
+        QMessageBox::warning(this, tr("Camera Intrinsics"), tr("Expected at least fx fy cx cy, got \"%1\"").arg(text));
+        return false;
+    }
+    return true;
+}
+
+void MainWindow::open_depth_image_dialog()
+{
+    if (m_gl_window)
+        m_gl_window->stop_rendering();
+
+    const QString depthPath = QFileDialog::getOpenFileName(this, tr("Open 16-bit depth image"), "../resources/pointclouds/", tr("Depth Images (*.png)"));
+    qDebug() << "Open depth image:" << depthPath;
+
+    graphics::CameraIntrinsics intrinsics;
+    if (!depthPath.isEmpty() && find_intrinsics(depthPath, intrinsics)) {
+        create_view();
+        const std::string colorPath = graphics::find_color_image(depthPath.toStdString());
+        if (m_gl_window->open_depth_image(depthPath.toStdString(), colorPath, intrinsics))
+            uncheck_live_inputs();
+        else
+            QMessageBox::warning(this, tr("Open Depth Image"), tr("%1 is not a 16-bit grayscale image").arg(depthPath));
+    }
+
+    if (m_gl_window){
+        m_gl_window->start_rendering();
+    }
+}
+
+void MainWindow::open_depth_sequence_dialog()
+{
+    if (m_gl_window)
+        m_gl_window->stop_rendering();
+
+    const QString directory = QFileDialog::getExistingDirectory(this, tr("Open depth sequence directory"), "../resources/pointclouds/");
+    qDebug() << "Open depth sequence:" << directory;
+
+    graphics::CameraIntrinsics intrinsics;
+    if (!directory.isEmpty() && find_intrinsics(directory, intrinsics)) {
+        create_view();
+        if (m_gl_window->open_depth_sequence(directory.toStdString(), intrinsics)) {
+            uncheck_live_inputs();
+            create_sequence_dialog();
+        } else {
+            QMessageBox::warning(this, tr("Open Depth Sequence"), tr("No depth PNG frames in %1").arg(directory));
+        }
+    }
+
+    if (m_gl_window){
+        m_gl_window->start_rendering();
+    }
+}
+
 void MainWindow::close_view()
 {
     if (!centralWidget())
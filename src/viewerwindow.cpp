@@ -1,5 +1,9 @@
 #include "viewerwindow.h"
 
+#ifndef GL_MULTISAMPLE
+#define GL_MULTISAMPLE 0x809D
+#endif
+
 ViewerWindow::ViewerWindow(std::shared_ptr<QOpenGLContext> opengl_context, QWindow *parent)
     : OpenGLWindow(opengl_context, parent)
 {
@@ -7,12 +11,68 @@ ViewerWindow::ViewerWindow(std::shared_ptr<QOpenGLContext> opengl_context, QWind
     QVector3D center(0.0f, 0.0f, 0.0f);
     QVector3D up(0.0f, 1.0F, 0.0f);
     m_camera_gl = std::make_shared<Camera>(eye, center, up);
+
+    m_follow_timer.setInterval(50);
+    connect(&m_follow_timer, &QTimer::timeout, this, &ViewerWindow::poll_followed_file);
+}
+
+ViewerWindow::~ViewerWindow()
+{
+    // The GL objects are released with the render context current, and before the uploader thread
+    // stops: it destroys the buffers of the abandoned uploads, see GLPointCloudObject::release_points(...)
+    const std::shared_ptr<QOpenGLContext> context = opengl_context();
+    const bool is_current = context && context->makeCurrent(this);
+    drop_upload();
+    drop_spatial_index();
+    drop_voxel_grid();
+    drop_outlier_filter();
+    drop_normals();
+    drop_color_attribute();
+    m_pointcloud_object.reset();
+    m_helpers_object.reset();
+    m_edl_object.reset();
+    m_points_target.destroy();
+    m_uploader.stop();
+    if (is_current)
+        context->doneCurrent();
+}
+
+// Only one source feeds the view at a time
+void ViewerWindow::stop_live_inputs()
+{
+    drop_upload();
+    drop_spatial_index();
+    drop_voxel_grid();
+    drop_outlier_filter();
+    drop_normals();
+    drop_color_attribute();
+    follow_file(false);
+    stop_stream();
+    detach_shared_ring();
+    m_sequence.reset();
+    m_sequence_playing = false;
 }
 
 void ViewerWindow::open_ply(const std::string& fname)
 {
+    stop_live_inputs();
     m_point_cloud_vertex_data = graphics::read_ply(fname);
+    m_path_file = fname;
+    // Normals estimated at a previous opening, otherwise estimated once the k-d tree is built
+    auto& normals = m_point_cloud_vertex_data.normals;
+    if (normals.empty() && !m_point_cloud_vertex_data.positions.empty()
+            && graphics::read_normals_cache(fname, m_point_cloud_vertex_data.positions.size(), normal_neighbours, normals)) {
+        m_normals_from_cache = true;
+        std::cout << "Normals read from " << graphics::normals_cache_file(fname) << std::endl;
+    }
     m_update_pointcloud = true;
+    build_spatial_index();
+    build_voxel_grid();
+
+    // The attribute shown for the previous file stays selected if this one has it too
+    if (m_pointcloud_object && nullptr == m_point_cloud_vertex_data.find_attribute(m_pointcloud_object->m_color_attribute))
+        m_pointcloud_object->m_color_attribute.clear();
+    build_color_attribute();
 
 //    std::string test_name = fname;
 //    test_name.replace(test_name.size()-4, test_name.size(), "");
@@ -21,64 +81,803 @@ void ViewerWindow::open_ply(const std::string& fname)
 //    graphics::write_ply(test_name, m_vertex_data);
 }
 
-std::unique_ptr<QOpenGLShaderProgram> ViewerWindow::create_drawing_shader()
-{
-    std::unique_ptr<QOpenGLShaderProgram> shader = std::make_unique<QOpenGLShaderProgram>();
-    shader->addShaderFromSourceCode(QOpenGLShader::Vertex,
-                                             "#version 130\n"
-                                             "in vec3 vertex_position;\n"
-                                             "in vec4 vertex_color;\n"
-                                             "in vec4 main_color;\n"
-                                             "out vec4 color;\n"
-                                             "uniform mat4 mvp;\n"
-                                             "void main(void)\n"
-                                             "{\n"
-                                             "    gl_Position = mvp * vec4(vertex_position, 1.0F);\n"
-                                             "    color = vertex_color * main_color;\n"
-                                             "}\n"
-                                         );
-    shader->addShaderFromSourceCode(QOpenGLShader::Fragment,
-                                             "#version 130\n"
-                                             "in vec4 color;\n"
-                                             "out vec4 frag_color;\n"
-                                             "void main(void)\n"
-                                             "{\n"
-                                             "    frag_color = color;\n"
-                                             "}\n"
-                                         );
-    shader->link();
-
-    if (!shader->isLinked()) {
-        std::cerr << "Error: m_shader_t shader is not linked" << std::endl;
-    }
-
-    return shader;
+bool ViewerWindow::open_depth_image(const std::string& depth_file, const std::string& color_file, const graphics::CameraIntrinsics& intrinsics)
+{
+    graphics::VertexData vertex_data = graphics::read_depth_image(depth_file, color_file, intrinsics);
+    if (vertex_data.positions.empty())
+        return false;
+
+    stop_live_inputs();
+    m_point_cloud_vertex_data = std::move(vertex_data);
+    m_path_file = depth_file;
+    m_update_pointcloud = true;
+    build_spatial_index();
+    build_voxel_grid();
+    if (m_pointcloud_object)
+        m_pointcloud_object->m_color_attribute.clear();
+    return true;
 }
 
-void ViewerWindow::initialize_gl()
+bool ViewerWindow::export_ply(const std::string& fname, const bool is_binary)
+{
+    if (m_point_cloud_vertex_data.positions.empty())
+        return false;
+
+    // Columns never selected for colouring are still only in the source file, read in one pass
+    std::vector<graphics::PointAttribute*> missing;
+    for (auto& attribute : m_point_cloud_vertex_data.attributes) {
+        if (!attribute.is_loaded())
+            missing.emplace_back(&attribute);
+    }
+    graphics::load_ply_attributes(m_path_file, missing);
+
+    return graphics::write_ply(fname, m_point_cloud_vertex_data, is_binary);
+}
+
+bool ViewerWindow::follow_file(const bool enable)
+{
+    if (!enable) {
+        m_follow_timer.stop();
+        m_tail_reader.reset();
+        return true;
+    }
+
+    if (m_path_file.empty() || is_streaming() || is_ring_attached())
+        return false;
+
+    // The shown frame of a sequence becomes the followed file
+    m_sequence.reset();
+    m_sequence_playing = false;
+    drop_upload(); // the cloud is going to grow
+    drop_spatial_index();
+    drop_voxel_grid();
+    drop_outlier_filter();
+    drop_normals();
+    drop_color_attribute();
+
+    // Reading starts after the records already loaded by read_ply(...)
+    std::unique_ptr<graphics::PlyTailReader> reader = std::make_unique<graphics::PlyTailReader>();
+    if (!reader->open(m_path_file, m_point_cloud_vertex_data.positions.size()))
+        return false;
+
+    // The appended records bring their positions, colors and normals only: the columns that
+    // could not be extended would be out of step with the cloud, on screen and on export
+    auto& all = m_point_cloud_vertex_data;
+    if (!all.normals.empty() && !reader->has_normals()) {
+        std::cout << "Following " << m_path_file << " drops the normals, the file has none" << std::endl;
+        all.normals.clear();
+    }
+    if (!all.attributes.empty()) {
+        std::cout << "Following " << m_path_file << " drops the " << all.attributes.size() << " vertex attributes" << std::endl;
+        all.attributes.clear();
+        if (m_pointcloud_object)
+            m_pointcloud_object->m_color_attribute.clear();
+    }
+
+    m_tail_reader = std::move(reader);
+    m_update_pointcloud = true; // uploaded once more, with spare capacity
+    m_follow_timer.start();
+    return true;
+}
+
+void ViewerWindow::poll_followed_file()
+{
+    if (nullptr == m_tail_reader)
+        return;
+
+    graphics::VertexData appended;
+    if (0 == m_tail_reader->poll(appended))
+        return;
+
+    auto& all = m_point_cloud_vertex_data;
+    const bool keep_colors = all.colors.size() == all.positions.size() && appended.colors.size() == appended.positions.size();
+    if (!keep_colors)
+        all.colors.clear();
+    const bool keep_normals = all.normals.size() == all.positions.size() && appended.normals.size() == appended.positions.size();
+    if (!keep_normals && !all.normals.empty()) {
+        std::cout << "Following " << m_path_file << " drops the normals" << std::endl;
+        all.normals.clear();
+    }
+
+    all.positions.insert(all.positions.end(), appended.positions.begin(), appended.positions.end());
+    m_appended_vertex_data.positions.insert(m_appended_vertex_data.positions.end(), appended.positions.begin(), appended.positions.end());
+    if (keep_colors) {
+        all.colors.insert(all.colors.end(), appended.colors.begin(), appended.colors.end());
+        m_appended_vertex_data.colors.insert(m_appended_vertex_data.colors.end(), appended.colors.begin(), appended.colors.end());
+    }
+    if (keep_normals) {
+        all.normals.insert(all.normals.end(), appended.normals.begin(), appended.normals.end());
+        m_appended_vertex_data.normals.insert(m_appended_vertex_data.normals.end(), appended.normals.begin(), appended.normals.end());
+    }
+}
+
+bool ViewerWindow::open_sequence(const std::string& directory)
+{
+    return start_sequence(std::make_unique<graphics::FrameSequence>(), directory, ".ply");
+}
+
+/*!
+ * \brief ViewerWindow::open_depth_sequence
+ * Plays the 16-bit depth PNGs of directory/depth (or of directory itself), each one with the
+ * colour image found by find_color_image(...). The frames are back-projected by the decoding threads.
+ */
+bool ViewerWindow::open_depth_sequence(const std::string& directory, const graphics::CameraIntrinsics& intrinsics)
+{
+    std::error_code ec;
+    const std::filesystem::path depth_directory = std::filesystem::path(directory) / "depth";
+    const bool has_depth_directory = std::filesystem::is_directory(depth_directory, ec);
+
+    std::unique_ptr<graphics::FrameSequence> sequence = std::make_unique<graphics::FrameSequence>();
+    sequence->set_decoder([intrinsics](const std::string& depth_file) {
+        return graphics::read_depth_image(depth_file, graphics::find_color_image(depth_file), intrinsics);
+    });
+    return start_sequence(std::move(sequence), has_depth_directory ? depth_directory.string() : directory, ".png");
+}
+
+bool ViewerWindow::start_sequence(std::unique_ptr<graphics::FrameSequence> sequence, const std::string& directory, const std::string& extension)
+{
+    stop_live_inputs();
+
+    if (!sequence->open(directory, extension))
+        return false;
+
+    m_sequence = std::move(sequence);
+    m_sequence_stalls = 0;
+    seek_sequence(0);
+    return true;
+}
+
+void ViewerWindow::play_sequence(const bool play)
+{
+    m_sequence_playing = play && nullptr != m_sequence;
+    m_sequence_deadline = std::chrono::steady_clock::now();
+}
+
+void ViewerWindow::seek_sequence(const std::size_t index)
+{
+    if (nullptr == m_sequence || 0 == m_sequence->size())
+        return;
+
+    m_sequence_next = index % m_sequence->size();
+    m_sequence_seek_pending = true;
+    m_sequence->seek(m_sequence_next);
+}
+
+// Called every frame, swaps in the next decoded frame when its deadline has passed
+void ViewerWindow::advance_sequence()
+{
+    if (nullptr == m_sequence || 0 == m_sequence->size())
+        return;
+
+    const auto now = std::chrono::steady_clock::now();
+    if (!m_sequence_seek_pending && (!m_sequence_playing || now < m_sequence_deadline))
+        return;
+
+    std::unique_ptr<graphics::VertexData> frame = m_sequence->take(m_sequence_next);
+    if (nullptr == frame) {
+        if (m_sequence_playing && !m_sequence_stalled)
+            m_sequence_stalls++;
+        m_sequence_stalled = true;
+        return;
+    }
+
+    m_sequence_stalled = false;
+    m_sequence_seek_pending = false;
+    m_point_cloud_vertex_data = std::move(*frame);
+    m_path_file = m_sequence->frame_name(m_sequence_next);
+    m_update_pointcloud = true;
+    m_sequence_shown = m_sequence_next;
+
+    if (m_sequence_playing) {
+        m_sequence_next = (m_sequence_next + 1) % m_sequence->size();
+        const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1. / m_sequence_fps));
+        // A late frame delays the following ones instead of making them catch up in a burst
+        m_sequence_deadline += period;
+        if (m_sequence_deadline < now)
+            m_sequence_deadline = now + period;
+    }
+}
+
+bool ViewerWindow::listen_stream(const std::string& address)
+{
+    stop_live_inputs();
+
+#ifdef Q_OS_LINUX
+    std::unique_ptr<graphics::PointStreamReceiver> receiver = std::make_unique<graphics::PointStreamReceiver>();
+    if (!receiver->listen(address))
+        return false;
+
+    m_stream_receiver = std::move(receiver);
+    m_stream_latency = 0.;
+    m_path_file = address;
+    return true;
+#else
+    std::cerr << "Listening on " << address << " failed: point streams are only received on Linux" << std::endl;
+    return false;
+#endif
+}
+
+void ViewerWindow::stop_stream()
+{
+#ifdef Q_OS_LINUX
+    m_stream_receiver.reset();
+#endif
+    m_stream_frame_timestamp = 0;
+}
+
+bool ViewerWindow::is_streaming() const
+{
+#ifdef Q_OS_LINUX
+    return nullptr != m_stream_receiver;
+#else
+    return false;
+#endif
+}
+
+// Called every frame, the latest received frame replaces the shown one
+void ViewerWindow::advance_stream()
+{
+#ifdef Q_OS_LINUX
+    if (nullptr == m_stream_receiver)
+        return;
+
+    std::unique_ptr<graphics::PointFrame> frame = m_stream_receiver->take_latest();
+    if (nullptr == frame)
+        return;
+
+    // Swapped, so the buffers of the previous frame go back to the receiver pool
+    std::swap(m_point_cloud_vertex_data, frame->vertex_data);
+    m_stream_frame_timestamp = frame->timestamp_ns;
+    m_update_pointcloud = true;
+    m_stream_receiver->recycle(std::move(frame));
+#endif
+}
+
+bool ViewerWindow::attach_shared_ring(const std::string& name)
+{
+    stop_live_inputs();
+
+#ifdef Q_OS_LINUX
+    std::unique_ptr<graphics::PointRing> ring = std::make_unique<graphics::PointRing>();
+    if (!ring->open(name))
+        return false;
+
+    m_ring = std::move(ring);
+    m_ring_has_frame = false;
+    m_ring_frames_shown = 0;
+    m_ring_frames_dropped = 0;
+    m_stream_latency = 0.;
+    m_path_file = name;
+    return true;
+#else
+    std::cerr << "Attaching " << name << " failed: point rings are only shared on Linux" << std::endl;
+    return false;
+#endif
+}
+
+void ViewerWindow::detach_shared_ring()
+{
+#ifdef Q_OS_LINUX
+    m_ring.reset();
+#endif
+    m_stream_frame_timestamp = 0;
+}
+
+bool ViewerWindow::is_ring_attached() const
 {
-    m_shader = create_drawing_shader();
+#ifdef Q_OS_LINUX
+    return nullptr != m_ring;
+#else
+    return false;
+#endif
+}
+
+// Called every frame with the context current, uploads the newest slot straight from the mapping
+void ViewerWindow::advance_shared_ring()
+{
+#ifdef Q_OS_LINUX
+    if (nullptr == m_ring)
+        return;
+
+    graphics::PointRing::View view;
+    if (!m_ring->read_latest(view) || (m_ring_has_frame && view.frame == m_ring_last_frame))
+        return;
+
+    if (m_ring_has_frame && view.frame > m_ring_last_frame + 1)
+        m_ring_frames_dropped += view.frame - m_ring_last_frame - 1;
+
+    m_ring_has_frame = true;
+    m_ring_last_frame = view.frame;
+
+    // A slot overwritten by the producer during the upload is not shown, the previous frame stays
+    const graphics::PointRing* ring = m_ring.get();
+    auto is_intact = [ring, &view]() { return ring->is_intact(view); };
+    const bool uploaded = m_software_rendering ? m_software_rasterizer.set_points(view.positions, view.colors, view.count, is_intact)
+                                               : m_pointcloud_object->upload_frame(view.positions, view.colors, view.count, is_intact);
+    if (uploaded) {
+        m_ring_frames_shown++;
+        m_stream_frame_timestamp = view.timestamp_ns;
+    } else {
+        m_ring_frames_dropped++;
+    }
+#endif
+}
+
+/*!
+ * \brief ViewerWindow::build_spatial_index
+ * Builds the k-d tree of the current cloud on a background thread, from a copy of the positions
+ * so that the cloud can be replaced meanwhile. poll_spatial_index() publishes it once built.
+ */
+void ViewerWindow::build_spatial_index()
+{
+    drop_spatial_index();
+    if (m_point_cloud_vertex_data.positions.empty())
+        return;
+
+    m_kdtree_cancel = std::make_shared<std::atomic<bool>>(false);
+    m_kdtree_future = std::async(std::launch::async, [positions = m_point_cloud_vertex_data.positions, cancel = m_kdtree_cancel]() {
+        std::shared_ptr<graphics::KdTree> kdtree = std::make_shared<graphics::KdTree>();
+        if (!kdtree->build(positions, cancel.get()))
+            return std::shared_ptr<graphics::KdTree>(nullptr);
+
+        std::cout << "k-d tree of " << kdtree->size() << " points built in " << kdtree->build_time() << " ms" << std::endl;
+        return kdtree;
+    });
+}
 
-    m_basis_center_object = std::make_unique<GLBasisObject>();
-    m_basis_center_object->set_shader(m_shader.get());
-    m_basis_center_object->initialize_gl();
+void ViewerWindow::drop_spatial_index()
+{
+    // A build in progress stops at its next range, waiting for it is short
+    if (m_kdtree_cancel)
+        *m_kdtree_cancel = true;
+    if (m_kdtree_future.valid())
+        m_kdtree_future.wait();
+
+    m_kdtree_future = {};
+    m_kdtree_cancel.reset();
+    m_kdtree.reset();
+}
 
-    m_camera_object = std::make_unique<GLCameraObject>();
-    m_camera_object->set_shader(m_shader.get());
-    m_camera_object->initialize_gl();
+void ViewerWindow::poll_spatial_index()
+{
+    if (m_kdtree_future.valid() && std::future_status::ready == m_kdtree_future.wait_for(std::chrono::seconds(0))) {
+        m_kdtree = m_kdtree_future.get();
+        m_kdtree_cancel.reset();
+        build_outlier_filter();
+        build_normals();
+    }
+}
+
+void ViewerWindow::set_voxel_size(const float size)
+{
+    m_voxel_size = std::max(0.F, size);
+    build_voxel_grid();
+}
+
+/*!
+ * \brief ViewerWindow::build_voxel_grid
+ * Decimates the loaded cloud on a background thread, the full cloud is shown meanwhile. The
+ * cloud is read in place: every path replacing or growing it drops the decimation first.
+ * Live inputs are never decimated.
+ */
+void ViewerWindow::build_voxel_grid()
+{
+    drop_voxel_grid();
+    if (m_voxel_size <= 0.F || m_point_cloud_vertex_data.positions.empty() || m_sequence || m_tail_reader || is_streaming() || is_ring_attached())
+        return;
+
+    m_voxel_cancel = std::make_shared<std::atomic<bool>>(false);
+    // The keep-mask is read in place as well, it is replaced only after this job is dropped
+    const std::vector<std::uint8_t>* keep = m_keep_mask.empty() ? nullptr : &m_keep_mask;
+    m_voxel_future = std::async(std::launch::async, [this, size = m_voxel_size, keep, cancel = m_voxel_cancel]() {
+        graphics::manual_timer timer;
+        timer.start();
+        std::unique_ptr<graphics::VertexData> decimated = std::make_unique<graphics::VertexData>(
+                    graphics::voxel_downsample(m_point_cloud_vertex_data, size, cancel.get(), keep));
+        timer.stop();
+
+        if (decimated->positions.empty())
+            return std::make_pair(std::unique_ptr<graphics::VertexData>(nullptr), 0.);
+        std::cout << "Voxel grid " << size << ": " << m_point_cloud_vertex_data.positions.size() << " -> "
+                  << decimated->positions.size() << " points in " << timer.get() << " ms" << std::endl;
+        return std::make_pair(std::move(decimated), timer.get());
+    });
+}
+
+void ViewerWindow::drop_voxel_grid()
+{
+    if (m_voxel_cancel)
+        *m_voxel_cancel = true;
+    if (m_voxel_future.valid())
+        m_voxel_future.wait();
+
+    m_voxel_future = {};
+    m_voxel_cancel.reset();
+    if (m_voxel_vertex_data) {
+        drop_upload(); // may be reading it
+        m_voxel_vertex_data.reset();
+        m_update_pointcloud = true; // back to the full cloud
+    }
+}
+
+void ViewerWindow::poll_voxel_grid()
+{
+    if (m_voxel_future.valid() && std::future_status::ready == m_voxel_future.wait_for(std::chrono::seconds(0))) {
+        auto [decimated, time] = m_voxel_future.get();
+        m_voxel_cancel.reset();
+        if (m_voxel_vertex_data)
+            drop_upload();
+        m_voxel_vertex_data = std::move(decimated);
+        m_voxel_time = time;
+        m_update_pointcloud = nullptr != m_voxel_vertex_data;
+    }
+}
+
+void ViewerWindow::set_outlier_filter(const bool enabled, const std::size_t k, const float sigma)
+{
+    m_outlier_enabled = enabled;
+    m_outlier_k = std::max<std::size_t>(1, k);
+    m_outlier_sigma = std::max(0.F, sigma);
+
+    const bool was_filtered = !m_keep_mask.empty();
+    build_outlier_filter();
+    if (was_filtered)
+        build_voxel_grid(); // without the mask until the new one is ready
+}
+
+/*!
+ * \brief ViewerWindow::build_outlier_filter
+ * Computes the keep-mask of the loaded cloud on a background thread with the published k-d tree,
+ * see graphics::statistical_outlier_mask(...). The positions are read in place like for the voxel
+ * grid, the file is not read again. Started again whenever a new tree is published.
+ */
+void ViewerWindow::build_outlier_filter()
+{
+    drop_outlier_filter();
+    if (!m_outlier_enabled || nullptr == m_kdtree || m_point_cloud_vertex_data.positions.empty())
+        return;
+
+    m_outlier_cancel = std::make_shared<std::atomic<bool>>(false);
+    m_outlier_future = std::async(std::launch::async, [this, tree = m_kdtree, k = m_outlier_k, sigma = m_outlier_sigma, cancel = m_outlier_cancel]() {
+        graphics::manual_timer timer;
+        timer.start();
+        std::vector<std::uint8_t> keep = graphics::statistical_outlier_mask(m_point_cloud_vertex_data.positions, *tree, k, sigma, cancel.get());
+        timer.stop();
+        return std::make_pair(std::move(keep), timer.get());
+    });
+}
+
+void ViewerWindow::drop_outlier_filter()
+{
+    if (m_outlier_cancel)
+        *m_outlier_cancel = true;
+    if (m_outlier_future.valid())
+        m_outlier_future.wait();
+
+    m_outlier_future = {};
+    m_outlier_cancel.reset();
+    if (!m_keep_mask.empty()) {
+        drop_voxel_grid(); // may be reading the mask
+        m_keep_mask.clear();
+        m_kept_indices.clear();
+        m_update_indices = true; // back to every point
+    }
+    m_outliers_removed = 0;
+}
+
+void ViewerWindow::poll_outlier_filter()
+{
+    if (!m_outlier_future.valid() || std::future_status::ready != m_outlier_future.wait_for(std::chrono::seconds(0)))
+        return;
+
+    auto [keep, time] = m_outlier_future.get();
+    m_outlier_cancel.reset();
+    if (keep.size() != m_point_cloud_vertex_data.positions.size())
+        return;
+
+    drop_voxel_grid();
+    m_keep_mask = std::move(keep);
+    m_kept_indices.clear();
+    for (std::size_t i=0; i<m_keep_mask.size(); i++) {
+        if (m_keep_mask[i])
+            m_kept_indices.emplace_back(static_cast<std::uint32_t>(i));
+    }
+    m_outliers_removed = m_keep_mask.size() - m_kept_indices.size();
+    m_outlier_time = time;
+    m_update_indices = true;
+    std::cout << "Outlier removal (k " << m_outlier_k << ", sigma " << m_outlier_sigma << "): " << m_outliers_removed << " of "
+              << m_keep_mask.size() << " points hidden in " << time << " ms" << std::endl;
+    build_voxel_grid();
+}
+
+/*!
+ * \brief ViewerWindow::build_normals
+ * Estimates the normals of a loaded PLY without any on a background thread with the published
+ * k-d tree, see graphics::estimate_normals(...), facing the scan origin. The result is written to
+ * the sidecar cache of the file by the same thread, so the next opening reads it instead.
+ */
+void ViewerWindow::build_normals()
+{
+    drop_normals();
+    const auto& vertex_data = m_point_cloud_vertex_data;
+    if (nullptr == m_kdtree || vertex_data.positions.empty() || vertex_data.normals.size() == vertex_data.positions.size())
+        return;
+
+    m_normals_cancel = std::make_shared<std::atomic<bool>>(false);
+    m_normals_future = std::async(std::launch::async, [this, tree = m_kdtree, file = m_path_file, cancel = m_normals_cancel]() {
+        graphics::manual_timer timer;
+        timer.start();
+        std::vector<QVector3D> normals = graphics::estimate_normals(m_point_cloud_vertex_data.positions, *tree, normal_neighbours, QVector3D(0, 0, 0), cancel.get());
+        timer.stop();
+        if (normals.empty())
+            return std::make_pair(std::move(normals), 0.);
+
+        std::cout << "Normals of " << normals.size() << " points estimated in " << timer.get() << " ms" << std::endl;
+        if (!graphics::write_normals_cache(file, normal_neighbours, normals))
+            std::cerr << "Could not write " << graphics::normals_cache_file(file) << std::endl;
+        return std::make_pair(std::move(normals), timer.get());
+    });
+}
+
+void ViewerWindow::drop_normals()
+{
+    if (m_normals_cancel)
+        *m_normals_cancel = true;
+    if (m_normals_future.valid())
+        m_normals_future.wait();
+
+    m_normals_future = {};
+    m_normals_cancel.reset();
+    m_normals_from_cache = false;
+    m_normals_time = 0.;
+}
+
+void ViewerWindow::poll_normals()
+{
+    if (!m_normals_future.valid() || std::future_status::ready != m_normals_future.wait_for(std::chrono::seconds(0)))
+        return;
+
+    auto [normals, time] = m_normals_future.get();
+    m_normals_cancel.reset();
+    if (normals.size() != m_point_cloud_vertex_data.positions.size())
+        return;
+
+    // The decimation reads the cloud in place and averages the normals too
+    const bool was_decimating = m_voxel_future.valid() || nullptr != m_voxel_vertex_data;
+    if (was_decimating)
+        drop_voxel_grid();
+    drop_upload();
+    m_point_cloud_vertex_data.normals = std::move(normals);
+    m_normals_time = time;
+    m_update_pointcloud = true; // uploaded for the shading
+    if (was_decimating)
+        build_voxel_grid();
+}
+
+/*!
+ * \brief ViewerWindow::drop_upload
+ * Waits for the uploads of the shown cloud to stop, they read it in place: every path replacing or
+ * modifying the cloud they may be reading drops them first. Uploaded again by the next frame when
+ * m_update_pointcloud is set.
+ */
+void ViewerWindow::drop_upload()
+{
+    if (m_pointcloud_object)
+        m_pointcloud_object->cancel_points(m_uploader);
+}
+
+const graphics::VertexData& ViewerWindow::displayed_vertex_data() const
+{
+    return m_voxel_vertex_data ? *m_voxel_vertex_data : m_point_cloud_vertex_data;
+}
+
+/*!
+ * \brief ViewerWindow::upload_software_points
+ * Copies the shown cloud to the software rasterizer, prepared like the GL buffers: in the draw
+ * order, so that the point budget draws a prefix, with the same colors. The outliers are left out
+ * of the copy instead of going through an index buffer.
+ */
+void ViewerWindow::upload_software_points()
+{
+    const graphics::VertexData& vertex_data = displayed_vertex_data();
+    const GLPointCloudObject::PreparedPoints prepared = GLPointCloudObject::prepare_points(vertex_data, m_pointcloud_object->point_settings(vertex_data));
+
+    // The decimated cloud has no outliers left, the mask is of the full one in file order
+    const std::size_t count = vertex_data.positions.size();
+    std::vector<std::uint8_t> keep;
+    if (!m_voxel_vertex_data && m_keep_mask.size() == count) {
+        keep.resize(count);
+        for (std::size_t j=0; j<count; j++)
+            keep[j] = m_keep_mask[static_cast<std::size_t>((j * prepared.order_stride) % count)];
+    }
+    m_software_rasterizer.set_points(prepared.positions, prepared.colors, keep);
+}
+
+std::vector<QString> ViewerWindow::stats_lines() const
+{
+    std::vector<QString> lines;
+    lines.emplace_back(QString("FPS: %1 (%2 ms)").arg(fps(), 0, 'f', 1).arg(render_time()));
+    lines.emplace_back(QString("Points: %1").arg(m_pointcloud_object ? m_pointcloud_object->drawn_count() : m_point_cloud_vertex_data.positions.size()));
+    if (!is_ring_attached() && nullptr == m_voxel_vertex_data && m_point_cloud_vertex_data.is_organized())
+        lines.back() += QString(" (%1x%2 grid)").arg(m_point_cloud_vertex_data.width).arg(m_point_cloud_vertex_data.height);
+
+    if (m_sequence)
+        lines.emplace_back(QString("Frame: %1 / %2, buffered %3, stalls %4").arg(m_sequence_shown + 1).arg(m_sequence->size())
+                           .arg(m_sequence->ready_count()).arg(m_sequence_stalls));
+#ifdef Q_OS_LINUX
+    if (m_stream_receiver)
+        lines.emplace_back(QString("Stream: %1 received, %2 dropped, latency %3 ms%4").arg(m_stream_receiver->frames_received())
+                           .arg(m_stream_receiver->frames_dropped()).arg(m_stream_latency, 0, 'f', 1)
+                           .arg(m_stream_receiver->is_connected() ? "" : " (no sender)"));
+#endif
+    if (m_voxel_vertex_data)
+        lines.emplace_back(QString("Voxel grid %1: %2 of %3 points, %4 ms").arg(static_cast<double>(m_voxel_size)).arg(m_voxel_vertex_data->positions.size())
+                           .arg(m_point_cloud_vertex_data.positions.size()).arg(m_voxel_time, 0, 'f', 1));
+    else if (m_voxel_future.valid())
+        lines.emplace_back(QString("Voxel grid %1: decimating...").arg(static_cast<double>(m_voxel_size)));
+    if (!m_keep_mask.empty())
+        lines.emplace_back(QString("Outliers: %1 hidden (k %2, sigma %3), %4 ms").arg(m_outliers_removed).arg(m_outlier_k)
+                           .arg(static_cast<double>(m_outlier_sigma)).arg(m_outlier_time, 0, 'f', 1));
+    else if (m_outlier_future.valid())
+        lines.emplace_back(QString("Outliers: filtering..."));
+    else if (m_outlier_enabled && m_kdtree_future.valid())
+        lines.emplace_back(QString("Outliers: waiting for the k-d tree"));
+    if (m_normals_from_cache)
+        lines.emplace_back(QString("Normals: read from the cache"));
+    else if (m_normals_time > 0.)
+        lines.emplace_back(QString("Normals: estimated in %1 ms (k %2)").arg(m_normals_time, 0, 'f', 1).arg(normal_neighbours));
+    else if (m_normals_future.valid())
+        lines.emplace_back(QString("Normals: estimating..."));
+    if (m_attribute_future.valid())
+        lines.emplace_back(QString("Attribute: loading %1...").arg(QString::fromStdString(m_pointcloud_object->m_color_attribute)));
+    if (m_kdtree)
+        lines.emplace_back(QString("k-d tree: built in %1 ms, %2 MB").arg(m_kdtree->build_time(), 0, 'f', 1)
+                           .arg(static_cast<double>(m_kdtree->memory_bytes()) / (1024. * 1024.), 0, 'f', 1));
+    else if (m_kdtree_future.valid())
+        lines.emplace_back(QString("k-d tree: building..."));
+    if (m_resolution_scaler.scale() < 1.F)
+        lines.emplace_back(QString("Resolution: %1%").arg(static_cast<int>(100.F * m_resolution_scaler.scale())));
+    if (m_frame_governor_enabled) {
+        const graphics::FrameGovernor::Levers& levers = m_frame_governor.levers();
+        lines.emplace_back(QString("Governor: %1 ms for %2 ms (%3), scale %4%, points %5%, size x%6, MSAA %7")
+                           .arg(m_frame_governor.frame_time(), 0, 'f', 1).arg(static_cast<double>(m_frame_governor.m_target_frame_time), 0, 'f', 1)
+                           .arg(m_render_graph.has_gpu_times() ? "GPU" : "CPU")
+                           .arg(static_cast<int>(100.F * levers.render_scale)).arg(static_cast<int>(100.F * levers.point_budget))
+                           .arg(static_cast<double>(levers.point_size_scale), 0, 'f', 1)
+                           .arg(samples() <= 1 ? QString("n/a") : (levers.msaa ? QString("%1x").arg(samples()) : QString("off"))));
+    }
+    QString passes;
+    for (const std::size_t i : m_render_graph.order()) {
+        const GLRenderGraph::Pass& pass = m_render_graph.passes()[i];
+        if (!pass.executed)
+            continue;
+        passes += QString(passes.isEmpty() ? "%1 %2" : ", %1 %2").arg(QString::fromStdString(pass.name)).arg(pass.cpu_time, 0, 'f', 2);
+        if (pass.timer)
+            passes += QString("/%1").arg(pass.timer->gpu_time(), 0, 'f', 2);
+    }
+    if (!passes.isEmpty())
+        lines.emplace_back(QString("Passes (ms%1): %2, %3 state changes").arg(m_render_graph.has_gpu_times() ? " CPU/GPU" : "")
+                           .arg(passes).arg(m_render_graph.state_changes()));
+    if (m_software_rendering)
+        lines.emplace_back(QString("Software rendering: %1 of %2 points in %3 ms, %4 threads").arg(m_software_rasterizer.drawn_count())
+                           .arg(m_software_rasterizer.size()).arg(m_software_rasterizer.render_time(), 0, 'f', 1).arg(graphics::hardware_threads()));
+    if (m_pointcloud_object && m_pointcloud_object->is_uploading())
+        lines.emplace_back(QString("Upload: in progress, %1 MB uploaded in total through %2").arg(static_cast<double>(m_uploader.bytes_uploaded()) / (1024. * 1024.), 0, 'f', 0)
+                           .arg(m_uploader.has_persistent_mapping() ? "the persistent staging ring" : "glBufferSubData"));
+    if (is_ring_attached())
+        lines.emplace_back(QString("Shared memory: %1 shown, %2 dropped, latency %3 ms").arg(m_ring_frames_shown)
+                           .arg(m_ring_frames_dropped).arg(m_stream_latency, 0, 'f', 1));
+    return lines;
+}
+
+std::vector<std::string> ViewerWindow::attribute_names() const
+{
+    std::vector<std::string> names;
+    for (const auto& a : m_point_cloud_vertex_data.attributes)
+        names.emplace_back(a.name);
+    return names;
+}
+
+bool ViewerWindow::select_color_attribute(const std::string& name)
+{
+    if (nullptr == m_pointcloud_object)
+        return false;
+
+    if (!name.empty() && nullptr == m_point_cloud_vertex_data.find_attribute(name))
+        return false;
+
+    // The points keep their colors until the column is loaded, see poll_color_attribute()
+    m_pointcloud_object->m_color_attribute = name;
+    m_update_pointcloud = true;
+    build_color_attribute();
+    return true;
+}
+
+/*!
+ * \brief ViewerWindow::build_color_attribute
+ * Columns are decoded from the file only the first time they are selected, on a thread of their
+ * own: the whole file is parsed again.
+ */
+void ViewerWindow::build_color_attribute()
+{
+    drop_color_attribute();
+    if (nullptr == m_pointcloud_object)
+        return;
+    const graphics::PointAttribute* attribute = m_point_cloud_vertex_data.find_attribute(m_pointcloud_object->m_color_attribute);
+    if (nullptr == attribute || attribute->is_loaded())
+        return;
+
+    m_attribute_future = std::async(std::launch::async, [file = m_path_file, attribute = graphics::PointAttribute{attribute->name, attribute->type, {}}]() mutable {
+        if (!graphics::load_ply_attribute(file, attribute))
+            attribute.data.clear();
+        return attribute;
+    });
+}
+
+void ViewerWindow::drop_color_attribute()
+{
+    if (m_attribute_future.valid())
+        m_attribute_future.wait();
+    m_attribute_future = {};
+}
+
+void ViewerWindow::poll_color_attribute()
+{
+    if (!m_attribute_future.valid() || std::future_status::ready != m_attribute_future.wait_for(std::chrono::seconds(0)))
+        return;
+
+    graphics::PointAttribute loaded = m_attribute_future.get();
+    graphics::PointAttribute* attribute = m_point_cloud_vertex_data.find_attribute(loaded.name);
+    if (nullptr == attribute)
+        return;
+    if (loaded.size() != m_point_cloud_vertex_data.positions.size()) {
+        std::cerr << "Could not load the attribute " << loaded.name << " of " << m_path_file << std::endl;
+        if (m_pointcloud_object && loaded.name == m_pointcloud_object->m_color_attribute)
+            m_pointcloud_object->m_color_attribute.clear();
+        return;
+    }
+
+    attribute->type = loaded.type;
+    attribute->data = std::move(loaded.data);
+    m_update_pointcloud = true; // colored through the LUT
+}
+
+void ViewerWindow::set_software_rendering(const bool enabled)
+{
+    if (enabled == m_software_rendering)
+        return;
+
+    // Each renderer holds its own copy of the points, the other one is released
+    m_software_rendering = enabled;
+    if (enabled)
+        drop_upload();
+    else
+        m_software_rasterizer.clear();
+    m_update_pointcloud = true;
+    std::cout << "Software rendering " << (enabled ? "on, " + std::to_string(graphics::hardware_threads()) + " threads" : std::string("off")) << std::endl;
+}
+
+void ViewerWindow::initialize_gl()
+{
+    // Before the shaders, they are written against the way the camera matrices are shared
+    m_camera_uniforms.initialize_gl();
+    m_shader_library.initialize_gl(&m_camera_uniforms);
+    m_uploader.start();
 
     m_pointcloud_object = std::make_unique<GLPointCloudObject>();
-    m_pointcloud_object->set_shader(m_shader.get());
+    m_pointcloud_object->set_shader(m_shader_library.program(GLShaderLibrary::points));
     m_pointcloud_object->initialize_gl();
 
-    m_center_point_object = std::make_unique<GLPointObject>();
-    m_center_point_object->set_shader(m_shader.get());
-    m_center_point_object->initialize_gl();
-    m_center_point_object->set_size(15);
+    m_helpers_object = std::make_unique<GLHelpersObject>();
+    m_helpers_object->set_shader(m_shader_library.program(GLShaderLibrary::lines));
+    m_helpers_object->initialize_gl();
+    m_helpers_object->set_point_size(15);
+
+    m_edl_object = std::make_unique<GLEdlObject>();
+    m_edl_object->set_shader(m_shader_library.program(GLShaderLibrary::composite, GLShaderLibrary::eye_dome));
+    m_edl_object->initialize_gl();
 
-    m_ground_grid_object = std::make_unique<GLGroundGridObject>();
-    m_ground_grid_object->set_shader(m_shader.get());
-    m_ground_grid_object->initialize_gl();
+    build_render_graph();
 }
 
 void ViewerWindow::resizeGL(int width, int height)
@@ -92,6 +891,128 @@ void ViewerWindow::resizeGL(int width, int height)
     m_camera_gl->update();
 }
 
+/*!
+ * \brief ViewerWindow::build_render_graph
+ * The frame as passes of m_render_graph, in the order they are declared unless reordered to save
+ * state changes. Values computed once per frame are in m_frame, set by paintGL() before running it.
+ * The overlay painted by paint(...) comes after the graph, in OpenGLWindow::render_now().
+ */
+void ViewerWindow::build_render_graph()
+{
+    m_render_graph.clear();
+
+    GLRenderState opaque;
+    GLRenderState composite;
+    composite.depth_func = GL_ALWAYS;
+    GLRenderState blended;
+    blended.blend = true; // for transparent vertex color
+    GLRenderState overlay = blended;
+    overlay.depth_test = false;
+
+    m_render_graph.add_pass("upload", std::nullopt, {}, [this]() {
+        if (m_software_rendering) {
+            // The rasterizer takes a copy within the frame, appended points come with the whole cloud
+            if (m_update_pointcloud || m_update_indices || !m_appended_vertex_data.positions.empty())
+                upload_software_points();
+            m_update_pointcloud = false;
+            m_update_indices = false;
+            m_appended_vertex_data = {};
+            return;
+        }
+        const std::size_t follow_capacity = m_tail_reader ? std::max(2 * m_point_cloud_vertex_data.positions.size(), follow_min_capacity) : 0;
+        if (m_update_pointcloud) {
+            // Large files go to the uploader thread, the points shown so far stay until they are swapped in.
+            // Live inputs are uploaded within the frame, they replace or grow the cloud all the time
+            m_update_pointcloud = false;
+            m_appended_vertex_data = {};
+            const graphics::VertexData& vertex_data = displayed_vertex_data();
+            const bool is_live = m_tail_reader || m_sequence || is_streaming() || is_ring_attached();
+            if (m_uploader.is_running() && !is_live && vertex_data.positions.size() >= async_upload_min_points) {
+                m_pointcloud_object->set_points_async(m_uploader, vertex_data);
+            } else {
+                m_pointcloud_object->set_points(vertex_data, follow_capacity);
+                m_update_indices = true;
+            }
+        } else if (!m_appended_vertex_data.positions.empty()) {
+            // Out of spare capacity everything is uploaded again with twice the room, amortised over the growth
+            if (!m_pointcloud_object->append_points(m_appended_vertex_data))
+                m_pointcloud_object->set_points(m_point_cloud_vertex_data, follow_capacity);
+            m_appended_vertex_data = {};
+        }
+        if (m_pointcloud_object->poll_points(m_uploader))
+            m_update_indices = true;
+        if (m_update_indices) {
+            // The decimated cloud has no outliers left, the full one hides them through the indices
+            m_update_indices = false;
+            m_pointcloud_object->set_indices(m_voxel_vertex_data ? std::vector<std::uint32_t>() : m_kept_indices);
+        }
+    }, [this]() {
+        return m_update_pointcloud || m_update_indices || !m_appended_vertex_data.positions.empty() || m_pointcloud_object->is_uploading();
+    });
+
+    m_render_graph.add_pass("points", opaque, {"upload"}, [this]() {
+        if (m_software_rendering) {
+            // Drawn on the CPU at the size and with the budget of the GL points, then uploaded to the target
+            const int width = std::clamp(static_cast<int>(std::lround(static_cast<float>(m_points_target.width()) * m_frame.scale)), 1, m_points_target.width());
+            const int height = std::clamp(static_cast<int>(std::lround(static_cast<float>(m_points_target.height()) * m_frame.scale)), 1, m_points_target.height());
+            const int point_size = std::max(1, static_cast<int>(std::lround(m_pointcloud_object->m_point_size * m_frame.point_size_scale * m_frame.scale)));
+            const std::size_t count = static_cast<std::size_t>(std::ceil(static_cast<double>(m_pointcloud_object->point_budget()) * static_cast<double>(m_software_rasterizer.size())));
+            m_software_rasterizer.render(m_camera_gl->get_projection_view_matrix() * m_pointcloud_object->get_model_mat(), width, height, point_size, count);
+            m_points_target.upload(m_software_rasterizer.colors().data(), m_software_rasterizer.depths().data(), width, height);
+            return;
+        }
+        if (m_frame.use_target) {
+            m_points_target.bind(m_frame.scale);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
+        // The variant of the points program compiled for the current settings, built at its first use
+        const QMatrix4x4& model_pc = m_pointcloud_object->get_model_mat();
+        m_pointcloud_object->set_view(m_camera_gl->get_view_matrix() * model_pc, m_camera_gl->distance());
+        m_pointcloud_object->set_shader(m_shader_library.program(GLShaderLibrary::points, m_pointcloud_object->shader_features()));
+        m_camera_uniforms.set_model(m_pointcloud_object->get_shader_program(), model_pc);
+        m_pointcloud_object->draw(m_pointcloud_object->m_point_size * m_frame.point_size_scale * (m_frame.use_target ? m_frame.scale : 1.F));
+        if (m_frame.use_target)
+            m_points_target.release();
+    }, [this]() {
+        return m_software_rendering ? m_software_rasterizer.size() > 0 && m_frame.use_target : m_pointcloud_object->drawn_count() > 0;
+    });
+
+    // With eye-dome lighting or a lower resolution the points went to a texture, composited with their depth
+    m_render_graph.add_pass("composite", composite, {"points"}, [this]() {
+        m_edl_object->set_shader(m_shader_library.program(GLShaderLibrary::composite, m_eye_dome_lighting ? GLShaderLibrary::eye_dome : GLShaderLibrary::no_feature));
+        m_edl_object->draw(m_points_target, m_camera_gl->near_clipping_plane, m_camera_gl->far_clipping_plane,
+                           Camera::perspective == m_camera_gl->m_projection_type, m_eye_dome_lighting);
+    }, [this]() {
+        return m_frame.use_target;
+    });
+
+    // Only the points are in the depth buffer at this point, the grid and the helpers come later
+    m_render_graph.add_pass("pick", std::nullopt, {"composite"}, [this]() {
+        m_pick_pending = false;
+        pick_center();
+    }, [this]() {
+        return m_pick_pending;
+    });
+
+    // Grid and gizmos share one buffer and the drawing shader, only the model matrix changes
+    m_render_graph.add_pass("grid", blended, {"pick"}, [this]() {
+        m_helpers_object->set_ground_height(m_camera_height);
+        m_camera_uniforms.set_model(m_helpers_object->get_shader_program(), QMatrix4x4());
+        m_helpers_object->draw_ground_grid();
+    });
+
+    m_render_graph.add_pass("gizmos", overlay, {"grid"}, [this]() {
+        QMatrix4x4 model;
+        model.translate(m_camera_gl->m_center);
+        m_camera_uniforms.set_model(m_helpers_object->get_shader_program(), model);
+        m_helpers_object->draw_center();
+    }, [this]() {
+        return m_draw_center_frame;
+    });
+
+    m_render_graph.initialize_gl();
+}
+
 void ViewerWindow::paintGL()
 {
     if (nullptr == m_camera_gl || nullptr == m_pointcloud_object)
@@ -100,74 +1021,142 @@ void ViewerWindow::paintGL()
 //    using namespace std::chrono_literals;
 //    std::this_thread::sleep_for(20ms);
 
-    if (m_update_pointcloud) {
-        m_update_pointcloud = false;
-        m_pointcloud_object->set_points(m_point_cloud_vertex_data);
-    }
+    advance_sequence();
+    advance_stream();
+    advance_shared_ring();
+    poll_spatial_index();
+    poll_voxel_grid();
+    poll_outlier_filter();
+    poll_normals();
+    poll_color_attribute();
 
+    glDepthMask(GL_TRUE);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glEnable(GL_DEPTH_TEST);
-
-    const QMatrix4x4& model_pc = m_pointcloud_object->get_model_mat();
-    m_camera_gl->set_standard_uniforms(m_pointcloud_object->get_shader_program(), model_pc);
-    m_pointcloud_object->draw(m_pointcloud_object->m_point_size);
 
-    if (m_ground_grid_object) {
-        glDepthFunc(GL_LESS);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // While the view moves the points are drawn at the resolution keeping the target frame time,
+    // full resolution is back as soon as the input stops
+    const bool interacting = m_is_left_mouse_pressed || m_is_right_mouse_pressed
+            || std::chrono::steady_clock::now() - m_last_interaction < interaction_timeout;
+    if (m_adaptive_resolution && interacting && !m_frame_governor_enabled)
+        m_resolution_scaler.update(static_cast<double>(render_time()));
+    else
+        m_resolution_scaler.reset();
 
-        QMatrix4x4 model;
-        model.translate(QVector3D(0,-m_camera_height,0));
-        model.scale(10);
-        model.rotate(90, QVector3D(1,0,0));
-        m_camera_gl->set_standard_uniforms(m_ground_grid_object->get_shader_program(), model);
-        m_ground_grid_object->draw();
-        glDisable(GL_BLEND);
+    // The governor holds the target frame time at all times, on the GPU time when it is measured and
+    // the points are drawn by the GPU
+    if (m_frame_governor_enabled)
+        m_frame_governor.update(m_render_graph.gpu_time() > 0. && !m_software_rendering ? m_render_graph.gpu_time() : static_cast<double>(render_time()));
+    else
+        m_frame_governor.reset();
+    const graphics::FrameGovernor::Levers& levers = m_frame_governor.levers();
+    m_frame.scale = std::min(m_resolution_scaler.scale(), levers.render_scale);
+    m_frame.point_size_scale = levers.point_size_scale;
+    if (samples() > 1) {
+        if (levers.msaa)
+            glEnable(GL_MULTISAMPLE);
+        else
+            glDisable(GL_MULTISAMPLE);
     }
+    m_pointcloud_object->set_point_budget(levers.point_budget);
 
-    glDisable(GL_DEPTH_TEST);
+    const QVector2D window_size = m_camera_gl->window_size();
+    m_frame.use_target = (m_software_rendering || m_eye_dome_lighting || m_frame.scale < 1.F) && m_edl_object
+            && m_points_target.resize(static_cast<int>(window_size.x()), static_cast<int>(window_size.y()));
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // for transparent vertex color
+    // Camera matrices once for every program, then only the model matrices that changed
+    m_camera_uniforms.update(*m_camera_gl);
+    m_render_graph.execute();
+}
 
-    if (m_draw_center_frame) {
+/*!
+ * \brief ViewerWindow::pick_center
+ * Reads back the depth buffer around the double-clicked pixel, takes the drawn point closest to
+ * it and moves the arcball center there. Only (2 * pick_radius + 1)^2 depth values are read, so
+ * the cost does not depend on the number of points, besides waiting for the frame being drawn.
+ * Called from paintGL() right after the point cloud is drawn.
+ * \return false if no point was drawn around the pixel
+ */
+bool ViewerWindow::pick_center()
+{
+    graphics::manual_timer timer;
+    timer.start();
 
-        if (m_basis_center_object) {
-            QMatrix4x4 model;
-            model.translate(m_camera_gl->m_center);
-            model.scale(0.2f);
-            model.rotate(180, QVector3D(1,0,0));
+    const QVector2D window_size = m_camera_gl->window_size();
+    const int width = static_cast<int>(window_size.x());
+    const int height = static_cast<int>(window_size.y());
+    const int x = m_pick_position.x();
+    const int y = height - 1 - m_pick_position.y(); // OpenGL rows go up
 
-            m_camera_gl->set_standard_uniforms(m_basis_center_object->get_shader_program(), model);
-            m_basis_center_object->draw();
-        }
-        if (m_center_point_object) {
-            graphics::VertexData center_of_view;
-            center_of_view.positions.emplace_back(m_camera_gl->m_center);
-            center_of_view.colors.emplace_back(QVector4D(1,1,0,0.5f));
-            m_center_point_object->set_point(center_of_view);
-
-            m_camera_gl->set_standard_uniforms(m_center_point_object->get_shader_program(), QMatrix4x4());
-            m_center_point_object->draw();
-        }
+    const int x0 = std::clamp(x - pick_radius, 0, width - 1);
+    const int y0 = std::clamp(y - pick_radius, 0, height - 1);
+    const int x1 = std::clamp(x + pick_radius, 0, width - 1);
+    const int y1 = std::clamp(y + pick_radius, 0, height - 1);
+    const int columns = x1 - x0 + 1;
+    const int rows = y1 - y0 + 1;
 
-        if (m_camera_object) {
-            QMatrix4x4 model;
-            model.translate(m_camera_gl->m_center);
-            model.scale(0.1f);
-            model.rotate(180, QVector3D(1,0,0));
+    std::vector<float> depths(static_cast<std::size_t>(columns * rows), 1.F);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(x0, y0, columns, rows, GL_DEPTH_COMPONENT, GL_FLOAT, depths.data());
 
-            m_camera_gl->set_standard_uniforms(m_camera_object->get_shader_program(), model);
-            m_camera_object->draw(QColor(0, 255, 255));
+    // Closest drawn pixel to the click, the nearest depth among equally close ones
+    int best_distance = std::numeric_limits<int>::max();
+    float best_depth = 1.F;
+    int best_x = 0;
+    int best_y = 0;
+    for (int r=0; r<rows; r++) {
+        for (int c=0; c<columns; c++) {
+            const float depth = depths[static_cast<std::size_t>(r * columns + c)];
+            const int distance = (x0 + c - x) * (x0 + c - x) + (y0 + r - y) * (y0 + r - y);
+            if (depth < 1.F && (distance < best_distance || (distance == best_distance && depth < best_depth))) {
+                best_distance = distance;
+                best_depth = depth;
+                best_x = x0 + c;
+                best_y = y0 + r;
+            }
         }
     }
+    if (best_distance == std::numeric_limits<int>::max())
+        return false;
+
+    const QVector4D ndc(2.F * (static_cast<float>(best_x) + 0.5F) / static_cast<float>(width) - 1.F,
+                        2.F * (static_cast<float>(best_y) + 0.5F) / static_cast<float>(height) - 1.F,
+                        2.F * best_depth - 1.F, 1.F);
+    const QVector4D world = m_camera_gl->get_projection_view_matrix().inverted() * ndc;
+    if (qFuzzyIsNull(world.w()))
+        return false;
 
+    m_camera_gl->set_center(world.toVector3D() / world.w());
+    timer.stop();
+    std::cout << "Picked center " << m_camera_gl->m_center.x() << " " << m_camera_gl->m_center.y() << " " << m_camera_gl->m_center.z()
+              << " in " << timer.get() << " ms" << std::endl;
+    Q_EMIT sig_update();
+    return true;
 }
 
 void ViewerWindow::paint(QPainter &painter)
 {
+    // The frame is submitted at this point, which ends the sender-to-screen latency
+    if (0 != m_stream_frame_timestamp) {
+        const double latency = static_cast<double>(graphics::point_frame_clock_ns() - m_stream_frame_timestamp) * 1e-6;
+        m_stream_latency = qFuzzyIsNull(m_stream_latency) ? latency : 0.9 * m_stream_latency + 0.1 * latency;
+        m_stream_frame_timestamp = 0;
+    }
 
+    if (!m_draw_stats)
+        return;
+
+    const std::vector<QString> lines = stats_lines();
+    const QFontMetrics metrics(painter.font());
+    const int line_height = metrics.height();
+    int width = 0;
+    for (const auto& line : lines)
+        width = std::max(width, metrics.horizontalAdvance(line));
+
+    constexpr int margin = 6;
+    painter.fillRect(QRect(0, 0, width + 2 * margin, static_cast<int>(lines.size()) * line_height + 2 * margin), QColor(0, 0, 0, 128));
+    painter.setPen(Qt::white);
+    for (std::size_t i=0; i<lines.size(); i++)
+        painter.drawText(margin, margin + static_cast<int>(i + 1) * line_height - metrics.descent(), lines[i]);
 }
 
 void ViewerWindow::keyPressEvent(QKeyEvent *e)
@@ -208,12 +1197,24 @@ void ViewerWindow::mouseMoveEvent(QMouseEvent *e)
 
     m_camera_gl->prev_mouse = cur_mouse;
 
-    if (m_is_left_mouse_pressed || m_is_right_mouse_pressed)
+    if (m_is_left_mouse_pressed || m_is_right_mouse_pressed) {
+        m_last_interaction = std::chrono::steady_clock::now();
         Q_EMIT sig_update();
+    }
+}
+
+void ViewerWindow::mouseDoubleClickEvent(QMouseEvent *e)
+{
+    // Picked in the next paintGL(), where the depth buffer of the points is available
+    if (e->button() == Qt::LeftButton) {
+        m_pick_position = e->pos();
+        m_pick_pending = true;
+    }
 }
 
 void ViewerWindow::wheelEvent(QWheelEvent *e)
 {
     m_camera_gl->zoom((-1)*static_cast<float>(e->angleDelta().y()));
+    m_last_interaction = std::chrono::steady_clock::now();
     Q_EMIT sig_update();
 }
@@ -0,0 +1,85 @@
+// Demo producer of the shared-memory point ring, for testing the viewer ring input.
+// Usage: pointring-producer [name] [points] [fps] [slots]
+//   name     shared memory name, /qt-pc-viewer-ring by default
+//   points   points per frame, 2000000 by default
+//   fps      frames per second, 30 by default
+//   slots    slots of the ring, 4 by default
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <thread>
+#include <chrono>
+#include <csignal>
+#include <algorithm>
+
+#include <pointring.h>
+
+static volatile std::sig_atomic_t running = 1;
+static void signal_handler(int) { running = 0; }
+
+int main(int argc, char *argv[])
+{
+    std::string name = graphics::PointRing::default_name;
+    std::size_t points = 2000000;
+    double fps = 30.;
+    std::uint32_t slots = 4;
+
+    try {
+        if (argc > 1) name = argv[1];
+        if (argc > 2) points = std::stoul(argv[2]);
+        if (argc > 3) fps = std::max(1., std::stod(argv[3]));
+        if (argc > 4) slots = static_cast<std::uint32_t>(std::max(2UL, std::stoul(argv[4])));
+    } catch (const std::exception&) {
+        std::cerr << "Usage: " << argv[0] << " [name] [points] [fps] [slots]" << std::endl;
+        return 1;
+    }
+
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    graphics::PointRing ring;
+    if (!ring.create(name, slots, points))
+        return 1;
+
+    const std::size_t side = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(points))));
+    const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1. / fps));
+    auto deadline = std::chrono::steady_clock::now();
+    std::size_t frame = 0;
+
+    std::cout << "Producing " << points << " points at " << fps << " fps into " << name << " (" << slots << " slots)" << std::endl;
+    while (running) {
+        // The frame is generated in place, straight into the shared slot
+        float* positions = nullptr;
+        std::uint8_t* colors = nullptr;
+        graphics::PointRingSlot* slot = ring.begin_write(positions, colors);
+
+        const float t = static_cast<float>(frame) / static_cast<float>(fps);
+        for (std::size_t i=0; i<points; i++) {
+            const float u = static_cast<float>(i % side) / static_cast<float>(side) - 0.5F;
+            const float v = static_cast<float>(i / side) / static_cast<float>(side) - 0.5F;
+            const float h = 0.05F * std::sin(25.F * u + 3.F * t) * std::cos(25.F * v - 2.F * t);
+            positions[3*i] = u;
+            positions[3*i+1] = h;
+            positions[3*i+2] = v;
+
+            const float c = (h / 0.05F + 1.F) * 0.5F;
+            colors[4*i] = static_cast<std::uint8_t>(255.F * c);
+            colors[4*i+1] = 96;
+            colors[4*i+2] = static_cast<std::uint8_t>(255.F * (1.F - c));
+            colors[4*i+3] = 255;
+        }
+        ring.end_write(slot, points, true);
+
+        frame++;
+        if (frame % static_cast<std::size_t>(fps * 5) == 0)
+            std::cout << "Published " << frame << " frames" << std::endl;
+
+        deadline += period;
+        std::this_thread::sleep_until(deadline);
+    }
+
+    std::cout << "Published " << frame << " frames" << std::endl;
+    return 0;
+}
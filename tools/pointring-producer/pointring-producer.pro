@@ -0,0 +1,26 @@
+QT       -= core gui
+
+CONFIG += c++latest console
+CONFIG -= app_bundle
+CONFIG(debug, debug|release) {
+    QMAKE_CXXFLAGS += -O0
+    TARGET = pointring-producer_debug
+} else {
+    QMAKE_CXXFLAGS += -O2
+    TARGET = pointring-producer
+}
+
+DESTDIR = $$PWD/../../bin
+
+TEMPLATE = app
+
+SOURCES += \
+    main.cpp \
+
+HEADERS += \
+    ../../include/common/pointframe.h \
+    ../../include/common/pointring.h \
+
+INCLUDEPATH += $$PWD/../../include/common
+
+LIBS += -lrt
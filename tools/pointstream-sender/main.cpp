@@ -0,0 +1,103 @@
+// Synthetic sender of the point frame protocol, for testing the viewer stream input.
+// Usage: pointstream-sender [address] [points] [fps] [--no-color]
+//   address  unix:/tmp/qt-pc-viewer.sock (default) or tcp:PORT
+//   points   points per frame, 1000000 by default
+//   fps      frames per second, 30 by default
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <thread>
+#include <chrono>
+#include <csignal>
+#include <algorithm>
+
+#include <pointframe.h>
+#include <localsocket.h>
+
+static volatile std::sig_atomic_t running = 1;
+static void signal_handler(int) { running = 0; }
+
+int main(int argc, char *argv[])
+{
+    std::string address = "unix:/tmp/qt-pc-viewer.sock";
+    std::size_t points = 1000000;
+    double fps = 30.;
+    bool with_color = true;
+
+    std::vector<std::string> positional;
+    for (int i=1; i<argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--no-color")
+            with_color = false;
+        else
+            positional.emplace_back(arg);
+    }
+    try {
+        if (positional.size() > 0) address = positional[0];
+        if (positional.size() > 1) points = std::stoul(positional[1]);
+        if (positional.size() > 2) fps = std::max(1., std::stod(positional[2]));
+    } catch (const std::exception&) {
+        std::cerr << "Usage: " << argv[0] << " [address] [points] [fps] [--no-color]" << std::endl;
+        return 1;
+    }
+
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    const int fd = graphics::open_local_socket(address, false);
+    if (fd < 0)
+        return 1;
+
+    // Animated wave on a square grid
+    const std::size_t side = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(points))));
+    std::vector<float> positions(points * 3);
+    std::vector<std::uint8_t> colors(with_color ? points * 4 : 0);
+
+    graphics::PointFrameHeader header;
+    header.count = points;
+    header.flags = with_color ? graphics::PointFrameHeader::has_rgba8 : 0;
+    header.payload_bytes = header.expected_payload_bytes();
+
+    const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1. / fps));
+    auto deadline = std::chrono::steady_clock::now();
+    std::size_t frame = 0;
+
+    std::cout << "Sending " << points << " points at " << fps << " fps to " << address << std::endl;
+    while (running) {
+        const float t = static_cast<float>(frame) / static_cast<float>(fps);
+        for (std::size_t i=0; i<points; i++) {
+            const float u = static_cast<float>(i % side) / static_cast<float>(side) - 0.5F;
+            const float v = static_cast<float>(i / side) / static_cast<float>(side) - 0.5F;
+            const float r = std::sqrt(u*u + v*v);
+            const float h = 0.05F * std::sin(40.F * r - 4.F * t);
+            positions[3*i] = u;
+            positions[3*i+1] = h;
+            positions[3*i+2] = v;
+            if (with_color) {
+                const float c = (h / 0.05F + 1.F) * 0.5F;
+                colors[4*i] = static_cast<std::uint8_t>(255.F * c);
+                colors[4*i+1] = static_cast<std::uint8_t>(255.F * (1.F - c));
+                colors[4*i+2] = 160;
+                colors[4*i+3] = 255;
+            }
+        }
+
+        header.timestamp_ns = graphics::point_frame_clock_ns();
+        if (!graphics::write_exact(fd, &header, sizeof(header))
+                || !graphics::write_exact(fd, positions.data(), positions.size() * sizeof(float))
+                || (with_color && !graphics::write_exact(fd, colors.data(), colors.size()))) {
+            std::cerr << "Viewer closed the connection" << std::endl;
+            break;
+        }
+
+        frame++;
+        deadline += period;
+        std::this_thread::sleep_until(deadline);
+    }
+
+    ::close(fd);
+    std::cout << "Sent " << frame << " frames" << std::endl;
+    return 0;
+}
@@ -0,0 +1,26 @@
+QT       -= core gui
+
+CONFIG += c++latest console
+CONFIG -= app_bundle
+CONFIG(debug, debug|release) {
+    QMAKE_CXXFLAGS += -O0
+    TARGET = pointstream-sender_debug
+} else {
+    QMAKE_CXXFLAGS += -O2
+    TARGET = pointstream-sender
+}
+
+DESTDIR = $$PWD/../../bin
+
+TEMPLATE = app
+
+SOURCES += \
+    main.cpp \
+
+HEADERS += \
+    ../../include/common/pointframe.h \
+    ../../include/common/localsocket.h \
+
+INCLUDEPATH += $$PWD/../../include/common
+
+LIBS += -lpthread